@@ -0,0 +1,517 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      bench/ffbench.cpp
+//! @brief     Microbenchmarks of form factor evaluation, per shape and regime, and of kernels
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! Usage: ffbench [--json] [--filter=<substring>] [--min-time=<seconds>] [--repetitions=<n>]
+//!
+//! Reports ns per evaluation and evaluations per second. With --json, the report is written
+//! in the format of Google Benchmark, so that its tools can compare runs for regressions.
+
+#include "ff/Cuboid.h"
+#include "ff/FormFactorTable.h"
+#include "ff/Intensity.h"
+#include "ff/Math.h"
+#include "ff/Penta.h"
+#include "ff/Platonic.h"
+#include "ff/PolyhedralKernels.h"
+#include "ff/PolyhedralSimd.h"
+#include "ff/Prism.h"
+#include "ff/Tri.h"
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+//! Receives results, so that the compiler cannot discard the benchmarked computations.
+volatile double sink;
+
+struct Options {
+    bool json = false;
+    std::string filter;
+    double min_time = 0.1; //!< seconds per repetition
+    int repetitions = 3;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations; //!< evaluations per repetition
+    double ns;         //!< per evaluation, fastest of all repetitions
+};
+
+//! Times fn, which returns the sum of n evaluations. The number of calls is doubled until one
+//! repetition takes min_time; then the fastest of all repetitions is reported.
+
+template <class Fn> Result measure(const std::string& name, size_t n, Fn fn, const Options& opt)
+{
+    using clock = std::chrono::steady_clock;
+    const auto time = [&fn](size_t calls) {
+        complex_t sum = 0;
+        const auto start = clock::now();
+        for (size_t c = 0; c < calls; ++c)
+            sum += fn();
+        const auto stop = clock::now();
+        sink = sum.real() + sum.imag();
+        return std::chrono::duration<double>(stop - start).count();
+    };
+    size_t calls = 1;
+    double t = time(calls);
+    while (t < opt.min_time && calls < (size_t(1) << 40)) {
+        calls *= 2;
+        t = time(calls);
+    }
+    for (int r = 1; r < opt.repetitions; ++r)
+        t = std::min(t, time(calls));
+    return {name, calls * n, 1e9 * t / (calls * n)};
+}
+
+//! Number of wavevectors per call, cycled through to avoid branch and cache artefacts of a
+//! single fixed input.
+const size_t nInputs = 64;
+
+//! Directions that cover the sphere evenly.
+std::vector<R3> directions(size_t n)
+{
+    std::vector<R3> result;
+    for (size_t i = 0; i < n; ++i) {
+        const double z = 1 - (2 * i + 1.) / n;
+        const double rho = std::sqrt(1 - z * z);
+        const double phi = 2.399963229728653 * i; // golden angle
+        result.emplace_back(rho * std::cos(phi), rho * std::sin(phi), z);
+    }
+    return result;
+}
+
+C3 complexify(const R3& q)
+{
+    return {q.x(), q.y(), q.z()};
+}
+
+//! Returns the outer unit normal of the first face without symmetry S2, or a null vector.
+R3 faceNormal(const ff::PolyhedralTopology& topology, const std::vector<R3>& vertices)
+{
+    for (const ff::PolygonalTopology& f : topology.faces) {
+        if (f.symmetry_S2)
+            continue;
+        const R3& a = vertices[f.vertexIndices[0]];
+        const R3& b = vertices[f.vertexIndices[1]];
+        const R3& c = vertices[f.vertexIndices[2]];
+        return (b - a).cross(c - b).unit();
+    }
+    return {};
+}
+
+struct Shape {
+    std::string name;
+    std::unique_ptr<ff::Polyhedron> p;
+    R3 normal; //!< of a face that is evaluated by power series for small q_pa
+};
+
+template <class S, class... Args> Shape shape(const std::string& name, std::vector<R3> vertices,
+                                              Args... args)
+{
+    return {name, std::make_unique<S>(args...), faceNormal(S::topology(), vertices)};
+}
+
+std::vector<Shape> shapes()
+{
+    using namespace ff;
+    std::vector<Shape> result;
+    result.push_back(
+        shape<platonic::Tetrahedron>("Tetrahedron", platonic::Tetrahedron::vertices(1.), 1.));
+    result.push_back(
+        shape<platonic::Octahedron>("Octahedron", platonic::Octahedron::vertices(1.), 1.));
+    result.push_back(
+        shape<platonic::Dodecahedron>("Dodecahedron", platonic::Dodecahedron::vertices(1.), 1.));
+    result.push_back(
+        shape<platonic::Icosahedron>("Icosahedron", platonic::Icosahedron::vertices(1.), 1.));
+    result.push_back(shape<cuboid::Cube>("Cube", cuboid::Cube::vertices(1.), 1.));
+    result.push_back(
+        shape<cuboid::Pave>("Pave", cuboid::Pave::vertices3(1., 2., 3.), 1., 2., 3.));
+    result.push_back(shape<penta::Decahedron>("Decahedron", penta::Decahedron::vertices(1.), 1.));
+    result.push_back(shape<penta::ElongatedDecahedron>(
+        "ElongatedDecahedron", penta::ElongatedDecahedron::vertices2(1., 2.), 1., 2.));
+    result.push_back(shape<penta::PentagonalBifrustum>(
+        "PentagonalBifrustum", penta::PentagonalBifrustum::vertices3(1., 1., .5), 1., 1., .5));
+    result.push_back(shape<penta::CappedPentagonalPrism>(
+        "CappedPentagonalPrism", penta::CappedPentagonalPrism::vertices3(1., 2., .5), 1., 2.,
+        .5));
+    result.push_back(shape<tri::TriangularBipyramid>(
+        "TriangularBipyramid", tri::TriangularBipyramid::vertices(1.), 1.));
+    result.push_back(shape<tri::ElongatedTriangularBipyramid>(
+        "ElongatedTriangularBipyramid", tri::ElongatedTriangularBipyramid::vertices2(1., 2.), 1.,
+        2.));
+    result.push_back(shape<tri::TriangularBifrustum>(
+        "TriangularBifrustum", tri::TriangularBifrustum::vertices3(1., 1., .5), 1., 1., .5));
+    return result;
+}
+
+//! Wavevectors of one evaluation regime, for an object of given radius.
+struct Regime {
+    std::string name;
+    std::vector<C3> q;
+};
+
+//! Returns wavevectors in the regimes of the evaluation algorithm. If normal is not null,
+//! this includes wavevectors almost perpendicular to a face, for which the face contribution
+//! is computed from the power series in q_pa.
+std::vector<Regime> regimes(double radius, const R3& normal)
+{
+    const std::vector<R3> u = directions(nInputs);
+    std::vector<Regime> result;
+    result.push_back({"zero", std::vector<C3>(nInputs, C3(0., 0., 0.))});
+    Regime series{"series", {}};
+    Regime analytic{"analytic", {}};
+    Regime complex{"complex", {}};
+    for (size_t i = 0; i < nInputs; ++i) {
+        series.q.push_back(complexify((5e-3 / radius) * u[i]));
+        analytic.q.push_back(complexify((5. / radius) * u[i]));
+        complex.q.push_back(complexify((5. / radius) * u[i])
+                            + complex_t(0, 0.5 / radius) * complexify(u[(i + 1) % nInputs]));
+    }
+    result.push_back(series);
+    if (normal.mag2() > 0) {
+        Regime face{"face_series", {}};
+        for (size_t i = 0; i < nInputs; ++i) {
+            const R3 t = u[i].cross(normal).unit(); // tilt perpendicular to the normal
+            face.q.push_back(complexify((3. / radius) * (normal + 1e-3 * t)));
+        }
+        result.push_back(face);
+    }
+    result.push_back(analytic);
+    result.push_back(complex);
+    return result;
+}
+
+bool selected(const std::string& name, const Options& opt)
+{
+    return name.find(opt.filter) != std::string::npos;
+}
+
+//! Benchmarks pointwise evaluation in all regimes, and batch evaluation of form factors, of
+//! intensities, of gradients, and of prism grids in the analytic one.
+template <class P>
+void benchShape(const std::string& name, const P& p, const R3& normal, const Options& opt,
+                std::vector<Result>& results)
+{
+    for (const Regime& r : regimes(p.radius(), normal)) {
+        const std::string full = name + "/" + r.name;
+        if (!selected(full, opt))
+            continue;
+        const bool real = r.name != "complex";
+        std::vector<R3> qr;
+        for (const C3& q : r.q)
+            qr.push_back(q.real());
+        if (real)
+            results.push_back(measure(
+                full, nInputs,
+                [&p, &qr] {
+                    complex_t sum = 0;
+                    for (const R3& q : qr)
+                        sum += p.formfactor(q);
+                    return sum;
+                },
+                opt));
+        else
+            results.push_back(measure(
+                full, nInputs,
+                [&p, &r] {
+                    complex_t sum = 0;
+                    for (const C3& q : r.q)
+                        sum += p.formfactor(q);
+                    return sum;
+                },
+                opt));
+    }
+
+    const std::string batch = name + "/analytic_batch";
+    const std::string intensity = name + "/intensity_batch";
+    const std::string gradient = name + "/gradient";
+    const std::string grid = name + "/grid";
+    if (!selected(batch, opt) && !selected(intensity, opt) && !selected(gradient, opt)
+        && !selected(grid, opt))
+        return;
+    const std::vector<R3> u = directions(1024);
+    std::vector<C3> q;
+    for (const R3& ui : u)
+        q.push_back(complexify((5. / p.radius()) * ui));
+    std::vector<complex_t> F(q.size());
+    std::vector<float> I(q.size());
+    if (selected(batch, opt))
+        results.push_back(measure(
+            batch, q.size(),
+            [&p, &q, &F] {
+                p.formfactor(q.data(), F.data(), q.size());
+                return F[0] + F[q.size() / 2];
+            },
+            opt));
+    if (selected(intensity, opt))
+        results.push_back(measure(
+            intensity, q.size(),
+            [&p, &q, &I] {
+                ff::intensity(p, q.data(), I.data(), q.size());
+                return complex_t(I[0] + I[q.size() / 2]);
+            },
+            opt));
+    if constexpr (std::is_base_of_v<ff::Polyhedron, P>)
+        if (selected(gradient, opt)) {
+            std::vector<C3> dFdv(p.nVertices());
+            results.push_back(measure(
+                gradient, q.size(),
+                [&p, &q, &dFdv] {
+                    complex_t sum = 0;
+                    C3 dFdq;
+                    for (const C3& qi : q)
+                        sum += p.formfactor_gradient(qi, &dFdq, dFdv.data()) + dFdq.x();
+                    return sum;
+                },
+                opt));
+        }
+    if constexpr (std::is_same_v<ff::Prism, P>)
+        if (selected(grid, opt)) {
+            // 32 x 32 grid of the same size as the batch, qz running fastest
+            std::vector<C3> qxy;
+            std::vector<complex_t> qz;
+            for (size_t i = 0; i < 32; ++i) {
+                qxy.push_back(C3(q[i].x(), q[i].y(), 0.));
+                qz.push_back(q[32 * i].z());
+            }
+            results.push_back(measure(
+                grid, qxy.size() * qz.size(),
+                [&p, &qxy, &qz, &F] {
+                    p.formfactor_grid(qxy.data(), qxy.size(), qz.data(), qz.size(), F.data());
+                    return F[0] + F[F.size() / 2];
+                },
+                opt));
+        }
+}
+
+//! Benchmarks pointwise evaluation under the accuracy settings for a few relative tolerances,
+//! for a logarithmic scan of |q|, as in demo/accuracy.cpp, so that the speedup over the
+//! default accuracy is tracked. The accuracy of p is restored afterwards.
+template <class P>
+void benchTolerance(const std::string& name, P& p, const Options& opt,
+                    std::vector<Result>& results)
+{
+    const std::vector<std::pair<std::string, double>> tolerances{
+        {"default", 0}, {"1e-4", 1e-4}, {"1e-6", 1e-6}, {"1e-8", 1e-8}};
+    const std::vector<R3> u = directions(nInputs);
+    std::vector<R3> q;
+    for (size_t i = 0; i < nInputs; ++i)
+        q.push_back((1e-4 * std::pow(2e5, i / (nInputs - 1.)) / p.radius()) * u[i]);
+
+    const ff::Accuracy saved = p.accuracy();
+    for (const auto& [label, tolerance] : tolerances) {
+        const std::string full = name + "/tol=" + label;
+        if (!selected(full, opt))
+            continue;
+        p.setAccuracy(tolerance ? ff::Accuracy::forTolerance(tolerance) : ff::Accuracy());
+        results.push_back(measure(
+            full, nInputs,
+            [&p, &q] {
+                complex_t sum = 0;
+                for (const R3& qi : q)
+                    sum += p.formfactor(qi);
+                return sum;
+            },
+            opt));
+    }
+    p.setAccuracy(saved);
+}
+
+//! Benchmarks batch lookup in a FormFactorTable, at the wavevectors of the analytic batch
+//! case, so that both can be compared.
+void benchTable(const std::string& name, const ff::Polyhedron& p, const Options& opt,
+                std::vector<Result>& results)
+{
+    const std::string full = name + "/table_batch";
+    if (!selected(full, opt))
+        return;
+    const ff::FormFactorTable table(p, 8 / p.radius(), 1e-3);
+    std::vector<R3> q;
+    for (const R3& ui : directions(1024))
+        q.push_back((5. / p.radius()) * ui);
+    std::vector<complex_t> F(q.size());
+    results.push_back(measure(
+        full, q.size(),
+        [&table, &q, &F] {
+            table.formfactor(q.data(), F.data(), q.size());
+            return F[0] + F[q.size() / 2];
+        },
+        opt));
+}
+
+//! Benchmarks the building blocks of the face and edge sums, for a pentagonal face.
+void benchKernels(const Options& opt, std::vector<Result>& results)
+{
+    std::vector<R3> pentagon;
+    for (int k = 0; k < 5; ++k)
+        pentagon.emplace_back(std::cos(0.4 * pi * k), std::sin(0.4 * pi * k), 1.);
+    const ff::PolyhedralFace face(pentagon, false);
+    const ff::PolyhedralEdge edge(pentagon[0], pentagon[1]);
+    const ff::Accuracy acc;
+
+    const std::vector<R3> u = directions(nInputs);
+    std::vector<R3> q, qpa, qpa_small;
+    std::vector<C3> qc, qpac;
+    std::vector<double> x;
+    std::vector<complex_t> z;
+    for (size_t i = 0; i < nInputs; ++i) {
+        q.push_back(5. * u[i]);
+        qpa.push_back(R3(5. * u[i].x(), 5. * u[i].y(), 0.));
+        qpa_small.push_back(1e-3 * qpa.back());
+        qc.push_back(complexify(q.back()) + complex_t(0, 0.5) * complexify(u[(i + 1) % nInputs]));
+        qpac.push_back(C3(qc.back().x(), qc.back().y(), 0.));
+        x.push_back(0.1 + 0.2 * i);
+        z.push_back(complex_t(x.back(), 0.3 - 0.01 * i));
+    }
+
+    const auto bench = [&](const std::string& name, auto fn) {
+        if (selected(name, opt))
+            results.push_back(measure(name, nInputs, fn, opt));
+    };
+    bench("kernel/PolyhedralEdge::contrib", [&] {
+        complex_t sum = 0;
+        for (size_t i = 0; i < nInputs; ++i)
+            sum += edge.contrib(5, qpac[i], qc[i].z());
+        return sum;
+    });
+    bench("kernel/sinc_real", [&] {
+        double sum = 0;
+        for (double xi : x)
+            sum += ff_aux::sinc(xi);
+        return complex_t(sum);
+    });
+    bench("kernel/sinc_complex", [&] {
+        complex_t sum = 0;
+        for (const complex_t& zi : z)
+            sum += ff_aux::sinc(zi);
+        return sum;
+    });
+    bench("kernel/expansion", [&] {
+        complex_t sum = 0;
+        for (const R3& qi : qpa_small)
+            sum += ff::kernel::expansion(face, 1., 1., qi, face.area(), acc);
+        return sum;
+    });
+    bench("kernel/edge_sum_ff_real", [&] {
+        complex_t sum = 0;
+        for (size_t i = 0; i < nInputs; ++i)
+            sum += ff::kernel::edge_sum_ff(face, q[i], qpa[i], false);
+        return sum;
+    });
+    bench("kernel/edge_sum_ff_complex", [&] {
+        complex_t sum = 0;
+        for (size_t i = 0; i < nInputs; ++i)
+            sum += ff::kernel::edge_sum_ff(face, qc[i], qpac[i], false);
+        return sum;
+    });
+}
+
+void printTable(const std::vector<Result>& results)
+{
+    std::cout << std::left << std::setw(48) << "# benchmark" << std::right << std::setw(12)
+              << "ns/eval" << std::setw(14) << "evals/s" << "\n";
+    for (const Result& r : results)
+        std::cout << std::left << std::setw(48) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.ns << std::scientific
+                  << std::setprecision(3) << std::setw(14) << 1e9 / r.ns << std::defaultfloat
+                  << "\n";
+}
+
+void printJson(const std::vector<Result>& results)
+{
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    std::cout << "{\n  \"context\": {\n"
+              << "    \"date\": \"" << date << "\",\n"
+              << "    \"executable\": \"ffbench\",\n"
+              << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+              << "    \"simd_vectorized\": " << (ff::simd::vectorized() ? "true" : "false")
+              << ",\n"
+              << "    \"simd_lanes\": " << ff::simd::lanes() << ",\n"
+              << "    \"simd_lanes_single\": " << ff::simd::lanes_single() << "\n"
+              << "  },\n  \"benchmarks\": [";
+    std::cout << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::cout << (i ? "," : "") << "\n    {\n"
+                  << "      \"name\": \"" << r.name << "\",\n"
+                  << "      \"run_type\": \"iteration\",\n"
+                  << "      \"iterations\": " << r.iterations << ",\n"
+                  << "      \"real_time\": " << r.ns << ",\n"
+                  << "      \"cpu_time\": " << r.ns << ",\n"
+                  << "      \"time_unit\": \"ns\",\n"
+                  << "      \"items_per_second\": " << 1e9 / r.ns << "\n    }";
+    }
+    std::cout << "\n  ]\n}\n";
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&arg](const std::string& key) {
+            return arg.rfind(key, 0) == 0 ? arg.substr(key.size()) : std::string();
+        };
+        try {
+            if (arg == "--json")
+                opt.json = true;
+            else if (arg.rfind("--filter=", 0) == 0)
+                opt.filter = value("--filter=");
+            else if (arg.rfind("--min-time=", 0) == 0)
+                opt.min_time = std::stod(value("--min-time="));
+            else if (arg.rfind("--repetitions=", 0) == 0)
+                opt.repetitions = std::max(1, std::stoi(value("--repetitions=")));
+            else
+                throw std::invalid_argument(arg);
+        } catch (const std::exception&) {
+            std::cerr << "Usage: ffbench [--json] [--filter=<substring>] [--min-time=<seconds>]"
+                         " [--repetitions=<n>]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const Shape& s : shapes()) {
+        benchShape(s.name, *s.p, s.normal, opt, results);
+        benchTolerance(s.name, *s.p, opt, results);
+        benchTable(s.name, *s.p, opt, results);
+    }
+    ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    benchShape("Prism", prism, R3(0., 0., 1.), opt, results);
+    benchTolerance("Prism", prism, opt, results);
+    benchKernels(opt, results);
+
+    if (opt.json)
+        printJson(results);
+    else
+        printTable(results);
+    return 0;
+}
@@ -0,0 +1,67 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      demo/accuracy.cpp
+//! @brief     Benchmarks form factor computation for different accuracy targets
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include <ff/Platonic.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+//! Prints computing time per wavevector, speedup, and deviation from default accuracy,
+//! for a logarithmic scan of |q| in random directions, as typical for small-angle scattering.
+
+int main()
+{
+    ff::platonic::Dodecahedron dodeca(1.);
+    const double R = dodeca.radius();
+
+    std::vector<C3> q;
+    std::mt19937 gen(42);
+    std::normal_distribution<double> normal;
+    for (double qR = 1e-4; qR < 20; qR *= 1.0002) {
+        const R3 u = R3(normal(gen), normal(gen), normal(gen)).unit();
+        q.push_back(C3(u.x(), u.y(), u.z()) * (qR / R));
+    }
+    const std::vector<complex_t> F0 = dodeca.formfactor(q);
+
+    std::cout << "# precision  tolerance  q_limit  qpa_limit  order  us/point  speedup"
+                 "  max rel deviation\n";
+    double t0 = 0;
+    auto run = [&](ff::Precision precision, double tolerance) {
+        const ff::Accuracy acc = ff::Accuracy::forTolerance(tolerance, precision);
+        dodeca.setAccuracy(acc);
+        const int repeat = 5;
+        std::vector<complex_t> F;
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; ++r)
+            F = dodeca.formfactor(q);
+        const auto stop = std::chrono::steady_clock::now();
+        const double t =
+            std::chrono::duration<double, std::micro>(stop - start).count() / repeat / q.size();
+        if (t0 == 0)
+            t0 = t;
+        double deviation = 0;
+        for (size_t i = 0; i < q.size(); ++i)
+            deviation = std::max(deviation, std::abs(F[i] - F0[i]) / std::abs(F0[i]));
+        std::cout << (precision == ff::Precision::Mixed ? "mixed " : "double ") << tolerance
+                  << " " << acc.q_limit_series << " " << acc.qpa_limit_series << " "
+                  << acc.seriesOrder() << " " << t << " " << t0 / t << " " << deviation
+                  << std::endl;
+    };
+    for (double tolerance : {2e-16, 1e-12, 1e-10, 1e-8, 1e-6, 1e-4, 1e-3})
+        run(ff::Precision::Double, tolerance);
+    // single precision only pays off for loose tolerances
+    for (double tolerance : {1e-5, 1e-4, 1e-3})
+        run(ff::Precision::Mixed, tolerance);
+}
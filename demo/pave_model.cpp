@@ -11,6 +11,7 @@
 //  ************************************************************************************************
 
 #include <ff/Cuboid.h>
+#include <ff/Intensity.h>
 #include <iostream>
 
 constexpr double twopi = 6.28318530718;
@@ -23,17 +24,19 @@ static double Iqabc(double qa, double qb, double qc,
     double edge_b,
     double edge_c)
 {
-    ff::cuboid::Pave pave(edge_a, edge_b, edge_c);
+    // reuse one pave per thread; re-parameterization is much cheaper than construction
+    thread_local ff::cuboid::Pave pave(edge_a, edge_b, edge_c);
+    pave.setParameters(edge_a, edge_b, edge_c);
     C3 q(qa, qb, qc);
 
-    // Amplitude AP from eqn. (13)
-    const double AP = abs(pave.formfactor(q));
-
-    // Multiply by contrast and volume
-    const double s = (sld-solvent_sld) * (edge_a * edge_b * edge_c);
-
-    // Convert from [1e-12 A-1] to [cm-1]
-    return 1.0e-4 * square(s * AP);
+    // Amplitude AP from eqn. (13), multiplied by contrast and volume, and
+    // converted from [1e-12 A-1] to [cm-1]
+    ff::IntensityParameters par;
+    par.contrast = (sld-solvent_sld) * (edge_a * edge_b * edge_c);
+    par.scale = 1.0e-4;
+    double result;
+    ff::intensity(pave, &q, &result, 1, par);
+    return result;
 }
 
 
@@ -0,0 +1,84 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Accuracy.cpp
+//! @brief     Implements struct Accuracy.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/Accuracy.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+//! The thresholds follow from error estimates of the two regimes:
+//! - The analytic formula for a polygon with q_pa*radius2d = x suffers from cancellations,
+//!   with relative error about 100 eps/x^2. Therefore qpa_limit_series = 10 sqrt(eps/tol),
+//!   but not above the default, which is a compromise for tol close to eps.
+//! - The polyhedral power series is cheaper than the analytic formula, so it should be used
+//!   as far as the truncation order stays at its default value 6, whose remainder scales as
+//!   q_red^7. Therefore q_limit_series grows as tol^(1/7), limited to 0.5, beyond which
+//!   |F| may be much smaller than the volume.
+//! For tol = eps, the default values are obtained.
+//!
+//! In mixed precision, with eps_f the single-precision epsilon:
+//! - A polygon suffers from cancellations with relative error about 10 eps_f/x^2, hence
+//!   qpa_limit_single = sqrt(10 eps_f/tol); faces below are computed in double precision.
+//! - The polyhedral face sum suffers from cancellations with relative error about
+//!   10 eps_f/q_red, hence q_min_single = 10 eps_f/tol, or q_limit_series if larger.
+//! - Phases are rounded to absolute error eps_f*q_red. The relative error of F is typically
+//!   below eps_f*q_red, but is amplified near minima of |F|, up to about 1000 eps_f*q_red,
+//!   hence q_max_single = tol/(1000 eps_f).
+//! The single-precision window is void for tol below about 1e-5.
+
+ff::Accuracy ff::Accuracy::forTolerance(double tolerance, Precision precision)
+{
+    Accuracy result;
+    result.tolerance = tolerance;
+    result.precision = precision;
+    const double eps = Accuracy().tolerance;
+    const double ratio = std::max(tolerance, eps) / eps;
+    result.q_limit_series = std::min(0.5, result.q_limit_series * std::pow(ratio, 1. / 7));
+    result.qpa_limit_series = std::min(result.qpa_limit_series, 10 / std::sqrt(ratio));
+    if (precision == Precision::Mixed) {
+        const double eps_f = std::numeric_limits<float>::epsilon() / 2;
+        result.q_min_single = std::max(result.q_limit_series, 10 * eps_f / tolerance);
+        result.q_max_single = tolerance / (1000 * eps_f);
+        result.qpa_limit_single = std::sqrt(10 * eps_f / tolerance);
+    }
+    result.validate();
+    return result;
+}
+
+int ff::Accuracy::seriesOrder() const
+{
+    int n = 0;
+    double bound = 1; // q_red^n/n! for q_red = q_limit_series
+    while (bound >= tolerance) {
+        ++n;
+        bound *= q_limit_series / n;
+    }
+    return n - 1;
+}
+
+void ff::Accuracy::validate() const
+{
+    if (!(tolerance > 0 && tolerance < 1))
+        throw std::invalid_argument("Invalid accuracy: tolerance must be in (0, 1)");
+    if (!(q_limit_series >= 0) || !(qpa_limit_series >= 0))
+        throw std::invalid_argument("Invalid accuracy: negative series limit");
+    if (!(q_min_single >= 0) || !(q_max_single >= 0) || !(qpa_limit_single >= 0))
+        throw std::invalid_argument("Invalid accuracy: negative single-precision limit");
+    if (n_limit_series < 1)
+        throw std::invalid_argument("Invalid accuracy: n_limit_series must be positive");
+    if (seriesOrder() > max_series_order)
+        throw std::invalid_argument(
+            "Invalid accuracy: q_limit_series too large for the given tolerance");
+}
@@ -0,0 +1,68 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Accuracy.h
+//! @brief     Defines struct Accuracy.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_ACCURACY_H
+#define FORMFACTOR_FF_ACCURACY_H
+
+#include <limits>
+
+namespace ff {
+
+//! Floating-point precision of the lockstep kernel for real wavevectors.
+
+//! With Mixed, phases and edge sums of the analytic formula for real wavevectors are computed
+//! in single precision as far as allowed by the thresholds q_min_single, q_max_single, and
+//! qpa_limit_single, and face sums are accumulated in double precision. Without SIMD
+//! instruction set, the lockstep kernel is not used, and Mixed has no effect.
+
+enum class Precision { Double, Mixed };
+
+//! Thresholds between evaluation regimes, and truncation of power series.
+
+//! The default values give the best attainable accuracy, which is limited to about 1e-11
+//! near the regime boundaries by cancellations in the analytic formula. For a looser
+//! relative tolerance, as is sufficient in least-squares fitting, forTolerance returns
+//! thresholds under which more wavevectors are computed from the cheap power series, and
+//! fewer terms are summed. See demo/accuracy.cpp, and the tol= cases of bench/ffbench.cpp,
+//! for benchmarks.
+
+struct Accuracy {
+    double tolerance = 2e-16;       //!< relative accuracy target, used to truncate series
+    double q_limit_series = 1e-2;   //!< polyhedron: power series if q*radius is below this
+    double qpa_limit_series = 1e-2; //!< polygon: power series if q_pa*radius2d is below this
+    int n_limit_series = 20;        //!< polygon: maximum order of the power series in q_pa
+    Precision precision = Precision::Double;
+    //! mixed precision: single-precision kernel if q*radius is in [q_min_single, q_max_single]
+    double q_min_single = std::numeric_limits<double>::infinity();
+    double q_max_single = 0;
+    //! mixed precision: faces with q_pa*radius2d below this are computed in double precision
+    double qpa_limit_single = std::numeric_limits<double>::infinity();
+
+    //! Highest order allowed for the polyhedral power series, see seriesOrder().
+    static const int max_series_order = 30;
+
+    //! Returns the accuracy settings for a given relative tolerance and precision.
+    static Accuracy forTolerance(double tolerance, Precision precision = Precision::Double);
+
+    //! Returns the order of the polyhedral power series beyond which terms are below
+    //! tolerance as long as q*radius < q_limit_series.
+    int seriesOrder() const;
+
+    //! Throws std::invalid_argument unless all settings are in range.
+    void validate() const;
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_ACCURACY_H
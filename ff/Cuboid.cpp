@@ -19,15 +19,20 @@ namespace ff::cuboid {
 //  class Cube
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Cube::topology()
+constexpr StaticTopology<6, 4> cubeTopology{
+    {{{3, 2, 1, 0}, true},
+     {{1, 2, 6, 5}, true},
+     {{0, 1, 5, 4}, true},
+     {{3, 0, 4, 7}, true},
+     {{2, 3, 7, 6}, true},
+     {{4, 5, 6, 7}, true}},
+    false};
+static_assert(cubeTopology.isValid(), "inconsistent topology of Cube");
+
+const ff::PolyhedralTopology& Cube::topology()
 {
-    return {{{{3, 2, 1, 0}, true},
-             {{1, 2, 6, 5}, true},
-             {{0, 1, 5, 4}, true},
-             {{3, 0, 4, 7}, true},
-             {{2, 3, 7, 6}, true},
-             {{4, 5, 6, 7}, true}},
-            false};
+    static const ff::PolyhedralTopology result = cubeTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Cube::vertices(const double edge)
@@ -39,22 +44,48 @@ std::vector<R3> Cube::vertices(const double edge)
     return {{a, -a, -a}, {a, a, -a}, {-a, a, -a}, {-a, -a, -a}, {a, -a, a}, {a, a, a}, {-a, a, a}, {-a, -a, a}};
 }
 
-Cube::Cube(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Cube::Cube(const double edge) : Cube(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Cube::Cube(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // O_h
+    setPointGroup(group);
+}
+
+void Cube::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Cube::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 
 //  ************************************************************************************************
 //  class Pave
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Pave::topology()
+constexpr StaticTopology<6, 4> paveTopology{
+    {{{3, 2, 1, 0}, true},
+     {{1, 2, 6, 5}, true},
+     {{0, 1, 5, 4}, true},
+     {{3, 0, 4, 7}, true},
+     {{2, 3, 7, 6}, true},
+     {{4, 5, 6, 7}, true}},
+    false};
+static_assert(paveTopology.isValid(), "inconsistent topology of Pave");
+
+const ff::PolyhedralTopology& Pave::topology()
 {
-    return {{{{3, 2, 1, 0}, true},
-             {{1, 2, 6, 5}, true},
-             {{0, 1, 5, 4}, true},
-             {{3, 0, 4, 7}, true},
-             {{2, 3, 7, 6}, true},
-             {{4, 5, 6, 7}, true}},
-            false};
+    static const ff::PolyhedralTopology result = paveTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Pave::vertices3(const double edge_a, const double edge_b, const double edge_c)
@@ -68,6 +99,27 @@ std::vector<R3> Pave::vertices3(const double edge_a, const double edge_b, const
     return {{a, -b, -c}, {a, b, -c}, {-a, b, -c}, {-a, -b, -c}, {a, -b, c}, {a, b, c}, {-a, b, c}, {-a, -b, c}};
 }
 
-Pave::Pave(const double edge_a, const double edge_b, const double edge_c) : ff::Polyhedron(topology(), vertices3(edge_a, edge_b, edge_c)) {}
+Pave::Pave(const double edge_a, const double edge_b, const double edge_c) : Pave(std::nothrow, edge_a, edge_b, edge_c)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Pave::Pave(std::nothrow_t, const double edge_a, const double edge_b, const double edge_c)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices3(edge_a, edge_b, edge_c))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices3(1., 2., 3.)); // D_2h, for unequal edges
+    setPointGroup(group);
+}
+
+void Pave::setParameters(const double edge_a, const double edge_b, const double edge_c)
+{
+    setShapeVertices(vertices3(edge_a, edge_b, edge_c));
+}
+
+ff::Outcome Pave::trySetParameters(const double edge_a, const double edge_b, const double edge_c)
+{
+    return trySetShapeVertices(vertices3(edge_a, edge_b, edge_c));
+}
 
 } // namespace ff::platonic
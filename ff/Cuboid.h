@@ -18,15 +18,21 @@ namespace ff::cuboid {
 
 class Cube : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Cube(const double edge);
+    Cube(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 class Pave : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices3(const double edge_a, const double edge_b, const double edge_c);
     Pave(const double edge_a, const double edge_b, const double edge_c);
+    Pave(std::nothrow_t, const double edge_a, const double edge_b, const double edge_c);
+    void setParameters(const double edge_a, const double edge_b, const double edge_c);
+    ff::Outcome trySetParameters(const double edge_a, const double edge_b, const double edge_c);
 };
 } // namespace ff::platonic
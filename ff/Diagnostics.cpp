@@ -0,0 +1,139 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Diagnostics.cpp
+//! @brief     Implements struct Diagnostics and class DiagnosticsScope.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/Diagnostics.h"
+
+namespace {
+
+//! The sink of the innermost DiagnosticsScope on this thread.
+thread_local ff::Diagnostics* activeSink = nullptr;
+
+void bump(std::vector<size_t>& histogram, size_t bin)
+{
+    if (bin >= histogram.size())
+        histogram.resize(bin + 1);
+    ++histogram[bin];
+}
+
+void add(std::vector<size_t>& histogram, const std::vector<size_t>& other)
+{
+    if (other.size() > histogram.size())
+        histogram.resize(other.size());
+    for (size_t i = 0; i < other.size(); ++i)
+        histogram[i] += other[i];
+}
+
+std::string format(const char* name, const std::vector<size_t>& histogram)
+{
+    std::string result = name;
+    for (size_t i = 0; i < histogram.size(); ++i)
+        if (histogram[i])
+            result += " " + std::to_string(i) + ":" + std::to_string(histogram[i]);
+    return result + "\n";
+}
+
+} // namespace
+
+
+std::atomic<int> ff::Diagnostics::nScopes{0};
+
+ff::Diagnostics* ff::Diagnostics::activeOnThread()
+{
+    return activeSink;
+}
+
+size_t ff::Diagnostics::evaluations() const
+{
+    size_t result = 0;
+    for (size_t n : regime)
+        result += n;
+    return result;
+}
+
+void ff::Diagnostics::clear()
+{
+    *this = Diagnostics();
+}
+
+ff::Diagnostics& ff::Diagnostics::operator+=(const Diagnostics& other)
+{
+    for (int r = 0; r < nRegimes; ++r)
+        regime[r] += other.regime[r];
+    add(seriesOrder, other.seriesOrder);
+    add(expandedFaces, other.expandedFaces);
+    add(expansionOrder, other.expansionOrder);
+    expansions += other.expansions;
+    return *this;
+}
+
+std::string ff::Diagnostics::message() const
+{
+    std::string result = "zero " + std::to_string(regime[Zero]) + ", series "
+                         + std::to_string(regime[Series]) + ", analytic "
+                         + std::to_string(regime[Analytic]) + ", prism "
+                         + std::to_string(regime[Prism]) + "\n";
+    if (!seriesOrder.empty())
+        result += format("series order", seriesOrder);
+    if (!expandedFaces.empty())
+        result += format("expanded faces", expandedFaces);
+    if (!expansionOrder.empty())
+        result += format("expansion order", expansionOrder);
+    return result;
+}
+
+void ff::Diagnostics::countSeries(int order)
+{
+    ++regime[Series];
+    bump(seriesOrder, order);
+}
+
+void ff::Diagnostics::countAnalytic(size_t expanded)
+{
+    ++regime[Analytic];
+    bump(expandedFaces, expanded);
+}
+
+void ff::Diagnostics::countPrism(size_t expanded)
+{
+    ++regime[Prism];
+    bump(expandedFaces, expanded);
+}
+
+void ff::Diagnostics::countExpansion(int order)
+{
+    ++expansions;
+    bump(expansionOrder, order);
+}
+
+void ff::Diagnostics::repeatExpansions(const std::vector<size_t>& before, size_t n)
+{
+    for (size_t k = 0; k < expansionOrder.size(); ++k) {
+        const size_t added = expansionOrder[k] - (k < before.size() ? before[k] : 0);
+        expansionOrder[k] += n * added;
+        expansions += n * added;
+    }
+}
+
+ff::DiagnosticsScope::DiagnosticsScope(Diagnostics& sink)
+    : m_previous(activeSink)
+{
+    activeSink = &sink;
+    ++Diagnostics::nScopes;
+}
+
+ff::DiagnosticsScope::~DiagnosticsScope()
+{
+    --Diagnostics::nScopes;
+    activeSink = m_previous;
+}
@@ -0,0 +1,93 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Diagnostics.h
+//! @brief     Defines struct Diagnostics and class DiagnosticsScope.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_DIAGNOSTICS_H
+#define FORMFACTOR_FF_DIAGNOSTICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ff {
+
+//! Histograms of the algorithms chosen in form factor evaluations.
+
+//! Evaluations are recorded while a DiagnosticsScope is active on the evaluating thread.
+//! Batches handed to a ParallelEvaluator are recorded in the sink of the calling thread.
+//! Recording costs a few integer increments per evaluation. As long as no scope is active on
+//! any thread, it costs one test of a global counter.
+
+struct Diagnostics {
+    //! Branch taken in the evaluation of one form factor.
+    enum Regime {
+        Zero,     //!< q = 0, F = volume
+        Series,   //!< polyhedron, power series in q
+        Analytic, //!< polyhedron, sum over faces
+        Prism,    //!< prism, 2d form factor of the base times sinc
+        nRegimes
+    };
+
+    std::array<size_t, nRegimes> regime{}; //!< number of evaluations per regime
+    std::vector<size_t> seriesOrder;       //!< [n]: series evaluations summed up to order n
+    std::vector<size_t> expandedFaces;     //!< [k]: analytic or prism evaluations with k faces
+                                           //!< expanded in q_pa
+    std::vector<size_t> expansionOrder;    //!< [n]: face expansions converged at order n
+    size_t expansions = 0;                 //!< total number of face expansions
+
+    //! Returns the sink of the calling thread, or nullptr if no DiagnosticsScope is active.
+    static Diagnostics* active()
+    {
+        return nScopes.load(std::memory_order_relaxed) ? activeOnThread() : nullptr;
+    }
+
+    size_t evaluations() const;
+    void clear();
+    Diagnostics& operator+=(const Diagnostics& other);
+    //! Returns the nonempty histograms, one per line.
+    std::string message() const;
+
+    void countZero() { ++regime[Zero]; }
+    void countSeries(int order);
+    void countAnalytic(size_t expanded);
+    void countPrism(size_t expanded);
+    void countExpansion(int order);
+    //! Records the face expansions counted since expansionOrder was equal to before, n more
+    //! times, for evaluations that share these expansions.
+    void repeatExpansions(const std::vector<size_t>& before, size_t n);
+
+private:
+    friend class DiagnosticsScope;
+    static std::atomic<int> nScopes; //!< number of active scopes on all threads
+    static Diagnostics* activeOnThread();
+};
+
+//! While an instance exists, form factor evaluations on the constructing thread are
+//! recorded in the given sink. Scopes may be nested; the innermost one is active.
+
+class DiagnosticsScope {
+public:
+    explicit DiagnosticsScope(Diagnostics& sink);
+    DiagnosticsScope(const DiagnosticsScope&) = delete;
+    DiagnosticsScope& operator=(const DiagnosticsScope&) = delete;
+    ~DiagnosticsScope();
+
+private:
+    Diagnostics* m_previous;
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_DIAGNOSTICS_H
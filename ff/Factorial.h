@@ -48,6 +48,20 @@ constexpr std::array<double, N> generateReciprocalFactorialArray()
     return generateArrayHelper<ReciprocalFactorial>(Indices{});
 }
 
+//! Returns a compile-time generated table of products of reciprocal factorials,
+//! table[i][j] = 1/(i! j!).
+
+template <size_t N>
+constexpr std::array<std::array<double, N>, N> generateReciprocalFactorialProductTable()
+{
+    constexpr std::array<double, N> r = generateReciprocalFactorialArray<N>();
+    std::array<std::array<double, N>, N> result{};
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j)
+            result[i][j] = r[i] * r[j];
+    return result;
+}
+
 } // namespace ff_aux
 
 #endif // FORMFACTOR_FF_FACTORIAL_H
@@ -0,0 +1,237 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/FormFactorTable.cpp
+//! @brief     Implements class FormFactorTable.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/FormFactorTable.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/Polyhedron.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+//! Number of random wavevectors per radial interval used to estimate the error.
+const size_t nSamples = 32;
+
+//! Weights of cubic Lagrange interpolation at x = s, 0 <= s < 1, from nodes x = -1, 0, 1, 2.
+void lagrange(float s, float* w)
+{
+    const float a = s * (s - 1) * (1.f / 6);
+    const float b = (s + 1) * (s - 2) * .5f;
+    w[0] = -a * (s - 2);
+    w[1] = b * (s - 1);
+    w[2] = -b * s;
+    w[3] = a * (s + 1);
+}
+
+} // namespace
+
+
+//! The step h = dq*radius follows from the interpolation error of exp(i*x) by a cubic
+//! through four equidistant nodes, which is at most 0.0234 h^4. Three interpolated
+//! coordinates, and rms |F| below the magnitude of the individual terms, require a margin,
+//! hence h = (tol/0.1)^(1/4), but at most 1. For platonic solids and paves, this yields
+//! errors about tol/2.
+
+ff::FormFactorTable::FormFactorTable(const Polyhedron& p, double q_max, double tolerance,
+                                     ParallelEvaluator* pe)
+    : m_p(p)
+    , m_q_max(q_max)
+    , m_tolerance(tolerance)
+{
+    if (!(q_max > 0))
+        throw std::invalid_argument("Invalid form factor table: q_max must be positive");
+    if (!(tolerance > 0))
+        throw std::invalid_argument("Invalid form factor table: tolerance must be positive");
+
+    const auto evaluate = [&p, pe](const std::vector<C3>& q, std::vector<complex_t>& F) {
+        F.resize(q.size());
+        if (pe)
+            pe->formfactor(p, q.data(), F.data(), q.size());
+        else
+            p.formfactor(q.data(), F.data(), q.size());
+    };
+
+    const double R = p.radius();
+    const double h = std::min(1., std::pow(tolerance / 0.1, 0.25));
+    m_dq = h / R;
+    m_nodes_per_q = 1 / m_dq;
+
+    // the error is sampled up to |q| = nIntervals*dq; the stencil reaches two nodes further
+    // in each coordinate, hence at most 2*sqrt(3) nodes further in |q|
+    const size_t nIntervals = static_cast<size_t>(q_max / m_dq) + 1;
+    m_n = static_cast<int>(nIntervals) + 2;
+    const double reach = nIntervals + 3.5;
+    const int L = 2 * m_n + 1;
+    m_values.assign(static_cast<size_t>(L) * L * (m_n + 2), Value(0));
+
+    // evaluate the nodes within reach, in chunks of planes kz to limit the workspace
+    std::vector<C3> q;
+    std::vector<size_t> index;
+    std::vector<complex_t> F;
+    for (int kz0 = -1; kz0 <= m_n;) {
+        q.clear();
+        index.clear();
+        int kz = kz0;
+        for (; kz <= m_n && q.size() < 65536; ++kz)
+            for (int ky = -m_n; ky <= m_n; ++ky)
+                for (int kx = -m_n; kx <= m_n; ++kx) {
+                    if (kx * kx + ky * ky + kz * kz > reach * reach)
+                        continue;
+                    q.emplace_back(kx * m_dq, ky * m_dq, kz * m_dq);
+                    index.push_back((static_cast<size_t>(kz + 1) * L + ky + m_n) * L + kx + m_n);
+                }
+        evaluate(q, F);
+        for (size_t l = 0; l < q.size(); ++l)
+            m_values[index[l]] = Value(F[l]);
+        kz0 = kz;
+    }
+
+    // sample the interpolation error
+    std::mt19937 gen(42);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+    q.clear();
+    for (size_t i = 0; i < nIntervals; ++i)
+        for (size_t l = 0; l < nSamples; ++l) {
+            const R3 u = R3(normal(gen), normal(gen), normal(gen)).unit();
+            const R3 qs = (i + uniform(gen)) * m_dq * u;
+            q.emplace_back(qs.x(), qs.y(), qs.z());
+        }
+    evaluate(q, F);
+    m_error.assign(nIntervals, 0.);
+    for (size_t i = 0; i < nIntervals; ++i) {
+        double max_diff = 0;
+        double sum2 = 0;
+        for (size_t l = i * nSamples; l < (i + 1) * nSamples; ++l) {
+            const complex_t f = lookup(q[l].real());
+            max_diff = std::max(max_diff, std::abs(f - F[l]));
+            sum2 += std::norm(F[l]);
+        }
+        m_error[i] = max_diff / std::sqrt(sum2 / nSamples);
+    }
+}
+
+double ff::FormFactorTable::errorEstimate() const
+{
+    double result = 0;
+    for (double e : m_error)
+        if (e <= m_tolerance)
+            result = std::max(result, e);
+    return result;
+}
+
+double ff::FormFactorTable::fallbackFraction() const
+{
+    const size_t n = std::count_if(m_error.begin(), m_error.end(),
+                                   [this](double e) { return !(e <= m_tolerance); });
+    return static_cast<double>(n) / m_error.size();
+}
+
+//! Returns F(q) by interpolation, or by exact evaluation where the table is not accurate.
+
+complex_t ff::FormFactorTable::formfactor(const R3& q) const
+{
+    complex_t result;
+    if (!interpolate(q, result))
+        result = m_p.formfactor(q);
+    return result;
+}
+
+//! Computes F(q[i]) for n wavevectors, and writes them to result[i]. Wavevectors that are not
+//! covered by the table are passed on, as a batch, to the exact form factor.
+
+void ff::FormFactorTable::formfactor(const R3* q, complex_t* result, size_t n) const
+{
+    std::vector<size_t> exact;
+    for (size_t i = 0; i < n; ++i)
+        if (!interpolate(q[i], result[i]))
+            exact.push_back(i);
+    if (exact.empty())
+        return;
+    std::vector<C3> qe;
+    qe.reserve(exact.size());
+    for (size_t i : exact)
+        qe.emplace_back(q[i].x(), q[i].y(), q[i].z());
+    std::vector<complex_t> F(exact.size());
+    m_p.formfactor(qe.data(), F.data(), qe.size());
+    for (size_t l = 0; l < exact.size(); ++l)
+        result[exact[l]] = F[l];
+}
+
+std::vector<complex_t> ff::FormFactorTable::formfactor(const std::vector<R3>& q) const
+{
+    std::vector<complex_t> result(q.size());
+    formfactor(q.data(), result.data(), q.size());
+    return result;
+}
+
+//! Sets result to the interpolated F(q), and returns true, unless |q| is out of range or
+//! the table is not accurate enough at |q|.
+
+bool ff::FormFactorTable::interpolate(const R3& q, complex_t& result) const
+{
+    const double t = q.mag();
+    if (!(t <= m_q_max))
+        return false;
+    if (!(m_error[static_cast<size_t>(t * m_nodes_per_q)] <= m_tolerance))
+        return false;
+    result = lookup(q);
+    return true;
+}
+
+//! Returns F(q) interpolated from the table, for |q| <= m_dq*(m_n-2).
+
+complex_t ff::FormFactorTable::lookup(const R3& q) const
+{
+    // in the lower half space, F(q) = conj(F(-q))
+    const bool lower = q.z() < 0;
+    const double s = lower ? -m_nodes_per_q : m_nodes_per_q;
+    // grid coordinates, counted from the first node, so that truncation rounds down
+    const double x = s * q.x() + m_n;
+    const double y = s * q.y() + m_n;
+    const double z = s * q.z() + 1;
+    const int ix = static_cast<int>(x);
+    const int iy = static_cast<int>(y);
+    const int iz = static_cast<int>(z);
+    // single precision suffices for the weights, as for the tabulated values
+    float wx[4], wy[4], wz[4];
+    lagrange(static_cast<float>(x - ix), wx);
+    lagrange(static_cast<float>(y - iy), wy);
+    lagrange(static_cast<float>(z - iz), wz);
+
+    // weighted sum of rows, each row segment being read as 8 floats (re, im, re, im, ...);
+    // rows are summed per plane, so that the four planes are independent chains
+    const size_t L = 2 * m_n + 1;
+    const Value* corner = &m_values[((iz - 1) * L + iy - 1) * L + ix - 1];
+    float sum[8] = {};
+    for (int c = 0; c < 4; ++c) {
+        float plane[8] = {};
+        for (int b = 0; b < 4; ++b) {
+            const float* row = reinterpret_cast<const float*>(corner + (c * L + b) * L);
+            for (int d = 0; d < 8; ++d)
+                plane[d] += wy[b] * row[d];
+        }
+        for (int d = 0; d < 8; ++d)
+            sum[d] += wz[c] * plane[d];
+    }
+    float re = 0;
+    float im = 0;
+    for (int a = 0; a < 4; ++a) {
+        re += wx[a] * sum[2 * a];
+        im += wx[a] * sum[2 * a + 1];
+    }
+    return {re, lower ? -im : im};
+}
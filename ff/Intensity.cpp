@@ -0,0 +1,63 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Intensity.cpp
+//! @brief     Implements functions intensity.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/Intensity.h"
+#include "ff/Polyhedron.h"
+#include "ff/Prism.h"
+#include <algorithm>
+
+namespace {
+
+//! Number of form factors held at once; 4 kB of complex values.
+const size_t block = 256;
+
+template <class Shape, class T>
+void blockwise(const Shape& p, const C3* q, T* result, size_t n, const ff::IntensityParameters& par)
+{
+    const double factor = par.scale * par.contrast * par.contrast;
+    complex_t F[block];
+    for (size_t i0 = 0; i0 < n; i0 += block) {
+        const size_t m = std::min(block, n - i0);
+        p.formfactor(q + i0, F, m);
+        for (size_t j = 0; j < m; ++j)
+            result[i0 + j] = static_cast<T>(factor * std::norm(F[j]) + par.background);
+    }
+}
+
+} // namespace
+
+
+void ff::intensity(const Polyhedron& p, const C3* q, double* result, size_t n,
+                   const IntensityParameters& par)
+{
+    blockwise(p, q, result, n, par);
+}
+
+void ff::intensity(const Polyhedron& p, const C3* q, float* result, size_t n,
+                   const IntensityParameters& par)
+{
+    blockwise(p, q, result, n, par);
+}
+
+void ff::intensity(const Prism& p, const C3* q, double* result, size_t n,
+                   const IntensityParameters& par)
+{
+    blockwise(p, q, result, n, par);
+}
+
+void ff::intensity(const Prism& p, const C3* q, float* result, size_t n,
+                   const IntensityParameters& par)
+{
+    blockwise(p, q, result, n, par);
+}
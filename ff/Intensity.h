@@ -0,0 +1,49 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Intensity.h
+//! @brief     Defines struct IntensityParameters and functions intensity.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_INTENSITY_H
+#define FORMFACTOR_FF_INTENSITY_H
+
+#include <heinz/Vectors3D.h>
+
+namespace ff {
+
+class Polyhedron;
+class Prism;
+
+//! Parameters of the scattered intensity I(q) = scale * contrast^2 * |F(q)|^2 + background.
+
+struct IntensityParameters {
+    double contrast = 1;   //!< scattering length density difference to the solvent
+    double scale = 1;      //!< e.g. number density, or conversion of units
+    double background = 0; //!< added to each intensity
+};
+
+//! Computes the intensities I(q[i]) for n wavevectors, and writes them to result[i].
+
+//! The form factors are computed by the batch evaluation of the shape, in blocks that are
+//! small enough for their complex values to stay in cache, so that no complex array of
+//! size n is ever written to memory.
+void intensity(const Polyhedron& p, const C3* q, double* result, size_t n,
+               const IntensityParameters& par = {});
+void intensity(const Polyhedron& p, const C3* q, float* result, size_t n,
+               const IntensityParameters& par = {});
+void intensity(const Prism& p, const C3* q, double* result, size_t n,
+               const IntensityParameters& par = {});
+void intensity(const Prism& p, const C3* q, float* result, size_t n,
+               const IntensityParameters& par = {});
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_INTENSITY_H
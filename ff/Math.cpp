@@ -0,0 +1,103 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Math.cpp
+//! @brief     Implements batched elementary functions of complex argument.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/Math.h"
+#include "ff/Simd.h"
+#include <algorithm>
+
+namespace {
+
+using ff::simd::width;
+
+//! Computes sin and cos of the real parts of z[0..m-1], with m <= width, in one SIMD pack.
+
+//! Without SIMD instruction set, the pack sincos is not vectorized, and std::sin and std::cos
+//! are faster.
+
+void sincosReal(const complex_t* z, size_t m, double* sx, double* cx)
+{
+    if constexpr (!ff::simd::is_vectorized) {
+        for (size_t l = 0; l < m; ++l) {
+            sx[l] = std::sin(z[l].real());
+            cx[l] = std::cos(z[l].real());
+        }
+        return;
+    }
+    double x[width] = {};
+    for (size_t l = 0; l < m; ++l)
+        x[l] = z[l].real();
+    ff::simd::Vd s, c;
+    ff::simd::sincos(ff::simd::Vd::load(x), s, c);
+    s.store(sx);
+    c.store(cx);
+}
+
+} // namespace
+
+
+void ff_aux::sincos(const complex_t* z, complex_t* s, complex_t* c, size_t n)
+{
+    double sx[width], cx[width];
+    for (size_t i = 0; i < n; i += width) {
+        const size_t m = std::min<size_t>(width, n - i);
+        sincosReal(z + i, m, sx, cx);
+        for (size_t l = 0; l < m; ++l) {
+            const double y = z[i + l].imag();
+            if (y == 0) {
+                s[i + l] = sx[l];
+                c[i + l] = cx[l];
+                continue;
+            }
+            double sh, ch;
+            sinhcosh(y, sh, ch);
+            s[i + l] = complex_t(sx[l] * ch, cx[l] * sh);
+            c[i + l] = complex_t(cx[l] * ch, -sx[l] * sh);
+        }
+    }
+}
+
+void ff_aux::exp_I(const complex_t* z, complex_t* result, size_t n)
+{
+    double sx[width], cx[width];
+    for (size_t i = 0; i < n; i += width) {
+        const size_t m = std::min<size_t>(width, n - i);
+        sincosReal(z + i, m, sx, cx);
+        for (size_t l = 0; l < m; ++l) {
+            const double y = z[i + l].imag();
+            const double e = y == 0 ? 1. : std::exp(-y);
+            result[i + l] = complex_t(e * cx[l], e * sx[l]);
+        }
+    }
+}
+
+void ff_aux::sinc(const complex_t* z, complex_t* result, size_t n)
+{
+    double sx[width], cx[width];
+    for (size_t i = 0; i < n; i += width) {
+        const size_t m = std::min<size_t>(width, n - i);
+        sincosReal(z + i, m, sx, cx);
+        for (size_t l = 0; l < m; ++l) {
+            const complex_t zl = z[i + l];
+            if (zl == complex_t(0., 0.)) {
+                result[i + l] = 1.;
+            } else if (zl.imag() == 0) {
+                result[i + l] = sx[l] / zl.real();
+            } else {
+                double sh, ch;
+                sinhcosh(zl.imag(), sh, ch);
+                result[i + l] = complex_t(sx[l] * ch, cx[l] * sh) / zl;
+            }
+        }
+    }
+}
@@ -0,0 +1,161 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Math.h
+//! @brief     Defines elementary functions of complex argument, scalar and batched.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! For internal use in the form factor kernels.
+//!
+//! With z = x + iy, all functions are composed from sin(x), cos(x), and either exp(-y) or
+//! sinh(y) and cosh(y), which are computed together from one call of expm1. The composition
+//! only involves products, hence each real or imaginary part has a relative error below
+//! 4 ulp, as compared to 1 ulp for sin(x) or cos(x) of real argument. For sinc, the final
+//! complex division adds cancellation in the components; the error bound of 6 ulp holds for
+//! the modulus of the deviation, relative to |sinc(z)|. If the library is compiled for a SIMD
+//! instruction set, the batched versions use the SIMD sincos, which costs another half ulp.
+//! These bounds are checked in test/MathTest.cpp.
+
+#ifndef FORMFACTOR_FF_MATH_H
+#define FORMFACTOR_FF_MATH_H
+
+#include <heinz/Complex.h>
+#include <cmath>
+#include <cstddef>
+
+namespace ff_aux {
+
+//! Computes sinh(y) and cosh(y) from one call of expm1.
+
+inline void sinhcosh(double y, double& sh, double& ch)
+{
+    const double a = std::abs(y);
+    if (a > 22.) { // exp(-a) is below one ulp of exp(a)
+        const double e = std::exp(a / 2); // avoids overflow of intermediate results
+        sh = (.5 * e) * e;
+        ch = sh;
+    } else {
+        const double t = std::expm1(a);
+        sh = .5 * (t + t / (t + 1));
+        ch = .5 * (t + 1) + .5 / (t + 1);
+    }
+    if (y < 0)
+        sh = -sh;
+}
+
+//! Computes sin(z) and cos(z).
+
+inline void sincos(complex_t z, complex_t& s, complex_t& c)
+{
+    const double sx = std::sin(z.real());
+    const double cx = std::cos(z.real());
+    if (z.imag() == 0) {
+        s = sx;
+        c = cx;
+        return;
+    }
+    double sh, ch;
+    sinhcosh(z.imag(), sh, ch);
+    s = complex_t(sx * ch, cx * sh);
+    c = complex_t(cx * ch, -sx * sh);
+}
+
+//! Returns sin(z).
+
+inline complex_t sin(complex_t z)
+{
+    if (z.imag() == 0)
+        return std::sin(z.real());
+    double sh, ch;
+    sinhcosh(z.imag(), sh, ch);
+    return {std::sin(z.real()) * ch, std::cos(z.real()) * sh};
+}
+
+//! Returns cos(z).
+
+inline complex_t cos(complex_t z)
+{
+    if (z.imag() == 0)
+        return std::cos(z.real());
+    double sh, ch;
+    sinhcosh(z.imag(), sh, ch);
+    return {std::cos(z.real()) * ch, -std::sin(z.real()) * sh};
+}
+
+//! Returns exp(iz).
+
+inline complex_t exp_I(complex_t z)
+{
+    const double sx = std::sin(z.real());
+    const double cx = std::cos(z.real());
+    if (z.imag() == 0)
+        return {cx, sx};
+    const double e = std::exp(-z.imag());
+    return {e * cx, e * sx};
+}
+
+//! Returns the cardinal sine function sin(z)/z.
+
+inline complex_t sinc(complex_t z)
+{
+    // This is an exception from the rule that we must not test floating-point numbers for equality.
+    // For small non-zero arguments, sin(z) returns quite accurately z or z-z^3/6.
+    // There is no loss of precision in computing sin(z)/z.
+    // Therefore there is no need for an expensive test like abs(z)<eps.
+    if (z == complex_t(0., 0.))
+        return 1.0;
+    if (z.imag() == 0)
+        return std::sin(z.real()) / z.real();
+    return sin(z) / z;
+}
+
+// Overloads for real argument, so that kernels templated on the wavevector type can use
+// the same function names for real and complex q.
+
+inline void sincos(double x, double& s, double& c)
+{
+    s = std::sin(x);
+    c = std::cos(x);
+}
+
+inline double sin(double x)
+{
+    return std::sin(x);
+}
+
+inline double cos(double x)
+{
+    return std::cos(x);
+}
+
+inline complex_t exp_I(double x)
+{
+    return {std::cos(x), std::sin(x)};
+}
+
+inline double sinc(double x)
+{
+    if (x == 0)
+        return 1.;
+    return std::sin(x) / x;
+}
+
+//! Computes s[i] = sin(z[i]) and c[i] = cos(z[i]) for i < n.
+void sincos(const complex_t* z, complex_t* s, complex_t* c, size_t n);
+
+//! Computes result[i] = exp(i*z[i]) for i < n.
+void exp_I(const complex_t* z, complex_t* result, size_t n);
+
+//! Computes result[i] = sinc(z[i]) for i < n.
+void sinc(const complex_t* z, complex_t* result, size_t n);
+
+} // namespace ff_aux
+
+#endif // FORMFACTOR_FF_MATH_H
@@ -0,0 +1,273 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/OrientationAverage.cpp
+//! @brief     Implements class OrientationAverager.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/OrientationAverage.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/PointGroup.h"
+#include "ff/Polyhedron.h"
+#include "ff/Prism.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+//! Computes the N/2 positive nodes x[i] and weights w[i] of N-point Gauss-Legendre quadrature
+//! on [-1,1], for even N.
+
+void gaussLegendre(size_t N, std::vector<double>& x, std::vector<double>& w)
+{
+    x.resize(N / 2);
+    w.resize(N / 2);
+    for (size_t i = 0; i < N / 2; ++i) {
+        double z = std::cos(pi * (i + .75) / (N + .5)); // initial guess
+        double dp;
+        for (int iter = 0; iter < 100; ++iter) {
+            // Legendre recurrence for P_N(z) and P_{N-1}(z)
+            double p0 = 1;
+            double p1 = z;
+            for (size_t k = 2; k <= N; ++k) {
+                const double p2 = ((2 * k - 1) * z * p1 - (k - 1) * p0) / k;
+                p0 = p1;
+                p1 = p2;
+            }
+            dp = N * (z * p1 - p0) / (z * z - 1);
+            const double dz = p1 / dp;
+            z -= dz;
+            if (std::abs(dz) < 1e-16)
+                break;
+        }
+        x[i] = z;
+        w[i] = 2 / ((1 - z * z) * dp * dp);
+    }
+}
+
+//! Intensity and amplitude averages from the product rule with N Gauss-Legendre nodes.
+struct Sums {
+    double intensity;
+    double amplitude;
+    size_t nDirections;
+};
+
+template <class Batch> Sums productRule(const Batch& ff, double q, size_t N)
+{
+    std::vector<double> x, w;
+    gaussLegendre(N, x, w);
+    const size_t M = 2 * N; // points in phi
+    std::vector<double> cphi(M), sphi(M);
+    for (size_t j = 0; j < M; ++j) {
+        cphi[j] = std::cos(2 * pi * (j + .5) / M);
+        sphi[j] = std::sin(2 * pi * (j + .5) / M);
+    }
+
+    // upper hemisphere only; the antipode of (x, phi) is (-x, phi+pi), where F is conjugate
+    std::vector<C3> qv;
+    qv.reserve(x.size() * M);
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double s = q * std::sqrt(1 - x[i] * x[i]);
+        for (size_t j = 0; j < M; ++j)
+            qv.emplace_back(s * cphi[j], s * sphi[j], q * x[i]);
+    }
+    std::vector<complex_t> F(qv.size());
+    ff(qv.data(), F.data(), qv.size());
+
+    // sum_i w_i = 1 over the upper hemisphere
+    Sums result{0, 0, qv.size()};
+    for (size_t i = 0; i < x.size(); ++i) {
+        double ring_I = 0;
+        double ring_A = 0;
+        for (size_t j = 0; j < M; ++j) {
+            const complex_t f = F[i * M + j];
+            ring_I += std::norm(f);
+            ring_A += f.real();
+        }
+        result.intensity += w[i] * ring_I / M;
+        result.amplitude += w[i] * ring_A / M;
+    }
+    return result;
+}
+
+//! Intensity and amplitude averages over the spherical triangle with the given corners, which
+//! is a fundamental domain of the Laue group, so that |F|^2 and Re F have the same average
+//! over the triangle as over the sphere.
+
+//! The triangle is integrated in geodesic polar coordinates around corner A. For a point Q
+//! that moves along the edge BC with parameter t, the arc from A to Q sweeps the polar
+//! angle psi(t), and the surface element is sin(rho) drho dpsi. Gauss-Legendre rules with N
+//! nodes are applied to rho in [0, |AQ|] and to t in [0, 1].
+
+template <class Batch>
+Sums triangleRule(const Batch& ff, double q, const std::array<R3, 3>& corners, size_t N)
+{
+    std::vector<double> x, w;
+    gaussLegendre(N, x, w);
+    std::vector<double> s(N), ws(N); // nodes and weights on [0,1]
+    for (size_t i = 0; i < N / 2; ++i) {
+        s[i] = (1 - x[i]) / 2;
+        s[N - 1 - i] = (1 + x[i]) / 2;
+        ws[i] = ws[N - 1 - i] = w[i] / 2;
+    }
+    // A at the smallest angle, where the polar nodes are most crowded
+    int a = 0;
+    double min_angle = 4;
+    for (int k = 0; k < 3; ++k) {
+        const R3& P = corners[k];
+        const R3 tb = corners[(k + 1) % 3] - P.dot(corners[(k + 1) % 3]) * P;
+        const R3 tc = corners[(k + 2) % 3] - P.dot(corners[(k + 2) % 3]) * P;
+        const double angle = std::acos(tb.unit().dot(tc.unit()));
+        if (angle < min_angle) {
+            min_angle = angle;
+            a = k;
+        }
+    }
+    const R3& A = corners[a];
+    const R3& B = corners[(a + 1) % 3];
+    const R3& C = corners[(a + 2) % 3];
+    const double L = std::acos(B.dot(C));
+
+    std::vector<C3> qv;
+    std::vector<double> weight;
+    qv.reserve(N * N);
+    weight.reserve(N * N);
+    for (size_t j = 0; j < N; ++j) {
+        // Q on the great circle from B to C, and its derivative with respect to t
+        const R3 Q = (std::sin((1 - s[j]) * L) * B + std::sin(s[j] * L) * C) / std::sin(L);
+        const R3 dQ =
+            (L / std::sin(L)) * (std::cos(s[j] * L) * C - std::cos((1 - s[j]) * L) * B);
+        const double rho_max = std::acos(std::min(1., A.dot(Q)));
+        const double sin_max = std::sin(rho_max);
+        const double dpsi = std::abs(dQ.dot(A.cross(Q))) / (sin_max * sin_max);
+        const R3 D = (Q - std::cos(rho_max) * A) / sin_max; // tangent at A towards Q
+        for (size_t i = 0; i < N; ++i) {
+            const double rho = s[i] * rho_max;
+            weight.push_back(ws[j] * dpsi * ws[i] * rho_max * std::sin(rho));
+            const R3 u = q * (std::cos(rho) * A + std::sin(rho) * D);
+            qv.emplace_back(u.x(), u.y(), u.z());
+        }
+    }
+    std::vector<complex_t> F(qv.size());
+    ff(qv.data(), F.data(), qv.size());
+
+    Sums result{0, 0, qv.size()};
+    double area = 0;
+    for (size_t k = 0; k < qv.size(); ++k) {
+        result.intensity += weight[k] * std::norm(F[k]);
+        result.amplitude += weight[k] * F[k].real();
+        area += weight[k];
+    }
+    result.intensity /= area;
+    result.amplitude /= area;
+    return result;
+}
+
+//! Rounds up to the next even number.
+size_t even(size_t n)
+{
+    return n + (n & 1);
+}
+
+} // namespace
+
+
+ff::OrientationAverager::OrientationAverager(double rel_tol, size_t max_order)
+    : m_rel_tol(rel_tol)
+    , m_max_order(max_order)
+{
+    if (!(rel_tol > 0))
+        throw std::invalid_argument("Invalid orientation averager: tolerance must be positive");
+}
+
+ff::OrientationAverage ff::OrientationAverager::average(const Polyhedron& p, double q) const
+{
+    return average([&p](const C3* qv, complex_t* F, size_t n) { p.formfactor(qv, F, n); },
+                   p.radius(), &p.pointGroup(), q);
+}
+
+ff::OrientationAverage ff::OrientationAverager::average(const Prism& p, double q) const
+{
+    return average([&p](const C3* qv, complex_t* F, size_t n) { p.formfactor(qv, F, n); },
+                   p.radius(), nullptr, q);
+}
+
+std::vector<ff::OrientationAverage>
+ff::OrientationAverager::average(const Polyhedron& p, const std::vector<double>& q,
+                                 ParallelEvaluator* pe) const
+{
+    return average([&p](const C3* qv, complex_t* F, size_t n) { p.formfactor(qv, F, n); },
+                   p.radius(), &p.pointGroup(), q, pe);
+}
+
+std::vector<ff::OrientationAverage>
+ff::OrientationAverager::average(const Prism& p, const std::vector<double>& q,
+                                 ParallelEvaluator* pe) const
+{
+    return average([&p](const C3* qv, complex_t* F, size_t n) { p.formfactor(qv, F, n); },
+                   p.radius(), nullptr, q, pe);
+}
+
+ff::OrientationAverage ff::OrientationAverager::average(const Batch& ff, double radius,
+                                                        const PointGroup* group, double q) const
+{
+    if (q == 0) {
+        const C3 q0(0., 0., 0.);
+        complex_t F0;
+        ff(&q0, &F0, 1);
+        return {std::norm(F0), F0.real(), 0., 1};
+    }
+    // the integrand |F(q*u)|^2 has angular bandwidth of about 2*q*radius; the initial N is
+    // scaled to the angular extent of the domain, pi for the hemisphere
+    std::array<R3, 3> corners;
+    const bool triangle = group && group->fundamentalTriangle(corners);
+    double extent = pi;
+    if (triangle) {
+        extent = 0;
+        for (int k = 0; k < 3; ++k)
+            extent = std::max(extent, std::acos(corners[k].dot(corners[(k + 1) % 3])));
+    }
+    const auto rule = [&](size_t n) {
+        return triangle ? triangleRule(ff, q, corners, n) : productRule(ff, q, n);
+    };
+    size_t N = even(static_cast<size_t>(std::ceil(std::abs(q) * radius * extent / pi)) + 4);
+    Sums prev = rule(N);
+    size_t nDirections = prev.nDirections;
+    while (true) {
+        N = even(N * 3 / 2);
+        const Sums next = rule(N);
+        nDirections += next.nDirections;
+        const double error = std::abs(next.intensity - prev.intensity);
+        if (error <= m_rel_tol * next.intensity || N * 3 / 2 > m_max_order)
+            return {next.intensity, next.amplitude, error, nDirections};
+        prev = next;
+    }
+}
+
+//! If pe is cancelled, entries that have not been computed have nDirections = 0.
+
+std::vector<ff::OrientationAverage>
+ff::OrientationAverager::average(const Batch& ff, double radius, const PointGroup* group,
+                                 const std::vector<double>& q, ParallelEvaluator* pe) const
+{
+    std::vector<OrientationAverage> result(q.size(), OrientationAverage{0., 0., 0., 0});
+    auto job = [&](size_t i0, size_t i1) {
+        for (size_t i = i0; i < i1; ++i)
+            result[i] = average(ff, radius, group, q[i]);
+    };
+    if (pe)
+        pe->run(job, q.size(), 1); // cost per q varies strongly, hence one q per chunk
+    else
+        job(0, q.size());
+    return result;
+}
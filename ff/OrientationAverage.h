@@ -0,0 +1,85 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/OrientationAverage.h
+//! @brief     Defines class OrientationAverager.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_ORIENTATIONAVERAGE_H
+#define FORMFACTOR_FF_ORIENTATIONAVERAGE_H
+
+#include <heinz/Complex.h>
+#include <heinz/Vectors3D.h>
+#include <functional>
+#include <vector>
+
+namespace ff {
+
+class ParallelEvaluator;
+class PointGroup;
+class Polyhedron;
+class Prism;
+
+//! Orientational averages of the form factor at one modulus |q|.
+
+struct OrientationAverage {
+    double intensity; //!< <|F|^2>
+    double amplitude; //!< <F>, which is real because F(-q) = conj(F(q))
+    double error;     //!< estimated absolute error of intensity
+    size_t nDirections;
+};
+
+//! Computes averages of the form factor over all directions of q, for isotropic samples.
+
+//! The sphere is integrated by a product rule, Gauss-Legendre in cos(theta) times trapezoid
+//! in phi, which is exact for spherical harmonics up to degree 2N-1, where N is the number
+//! of Gauss-Legendre nodes. Since F(-q) = conj(F(q)) for real q, only one hemisphere is
+//! evaluated. The initial N is chosen from the angular bandwidth q*radius; N is then raised
+//! by a factor 3/2 until two successive intensities agree within the relative tolerance.
+//! The difference of the last two intensities is returned as error estimate. If max_order
+//! is reached without convergence, the last result is returned as is.
+//!
+//! If the Laue group of a polyhedron has a fundamental triangle, see PointGroup, then only
+//! that triangle is integrated, by Gauss-Legendre rules in geodesic polar coordinates. The
+//! saving grows with q*radius and with the group order; for q*radius = 26 to 42 and
+//! tolerance 1e-8, the number of directions is reduced by 10 for the dodecahedron, by 2.6
+//! for the cube, and by 1.4 for the pave.
+
+class OrientationAverager {
+public:
+    explicit OrientationAverager(double rel_tol = 1e-6, size_t max_order = 1000);
+
+    OrientationAverage average(const Polyhedron& p, double q) const;
+    OrientationAverage average(const Prism& p, double q) const;
+
+    //! Averages for several |q|, distributed over the threads of pe, or serially if pe=nullptr.
+    std::vector<OrientationAverage> average(const Polyhedron& p, const std::vector<double>& q,
+                                            ParallelEvaluator* pe = nullptr) const;
+    std::vector<OrientationAverage> average(const Prism& p, const std::vector<double>& q,
+                                            ParallelEvaluator* pe = nullptr) const;
+
+private:
+    //! Batch form factor evaluation F(q[i]) -> result[i], for i < n.
+    using Batch = std::function<void(const C3* q, complex_t* result, size_t n)>;
+
+    double m_rel_tol;
+    size_t m_max_order;
+
+    OrientationAverage average(const Batch& ff, double radius, const PointGroup* group,
+                               double q) const;
+    std::vector<OrientationAverage> average(const Batch& ff, double radius,
+                                            const PointGroup* group,
+                                            const std::vector<double>& q,
+                                            ParallelEvaluator* pe) const;
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_ORIENTATIONAVERAGE_H
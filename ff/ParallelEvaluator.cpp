@@ -0,0 +1,226 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/ParallelEvaluator.cpp
+//! @brief     Implements class ParallelEvaluator.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/ParallelEvaluator.h"
+#include "ff/Diagnostics.h"
+#include "ff/Polyhedron.h"
+#include "ff/Prism.h"
+#include <algorithm>
+#include <stdexcept>
+
+ff::ParallelEvaluator::ParallelEvaluator(size_t n_threads, size_t chunk_size)
+    : m_chunk_size(chunk_size)
+{
+    if (chunk_size == 0)
+        throw std::runtime_error("Invalid parallel evaluator: chunk size must be positive");
+    if (n_threads == 0)
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t id = 0; id < n_threads; ++id)
+        m_queues.emplace_back(std::make_unique<Queue>());
+    for (size_t id = 1; id < n_threads; ++id)
+        m_threads.emplace_back(&ParallelEvaluator::loop, this, id);
+}
+
+ff::ParallelEvaluator::~ParallelEvaluator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_threads)
+        t.join();
+}
+
+bool ff::ParallelEvaluator::formfactor(const Polyhedron& p, const C3* q, complex_t* result,
+                                       size_t n)
+{
+    return runRecorded([&](size_t i0, size_t i1) { p.formfactor(q + i0, result + i0, i1 - i0); },
+                       n);
+}
+
+bool ff::ParallelEvaluator::formfactor(const Prism& p, const C3* q, complex_t* result, size_t n)
+{
+    return runRecorded([&](size_t i0, size_t i1) { p.formfactor(q + i0, result + i0, i1 - i0); },
+                       n);
+}
+
+bool ff::ParallelEvaluator::formfactor_grid(const Prism& p, const C3* qxy, size_t nxy,
+                                            const complex_t* qz, size_t nz, complex_t* result)
+{
+    return runRecorded(
+        [&](size_t i0, size_t i1) {
+            p.formfactor_grid(qxy + i0, i1 - i0, qz, nz, result + i0 * nz);
+        },
+        nxy);
+}
+
+bool ff::ParallelEvaluator::intensity(const Polyhedron& p, const C3* q, double* result, size_t n,
+                                      const IntensityParameters& par)
+{
+    return runRecorded(
+        [&](size_t i0, size_t i1) { ff::intensity(p, q + i0, result + i0, i1 - i0, par); }, n);
+}
+
+bool ff::ParallelEvaluator::intensity(const Polyhedron& p, const C3* q, float* result, size_t n,
+                                      const IntensityParameters& par)
+{
+    return runRecorded(
+        [&](size_t i0, size_t i1) { ff::intensity(p, q + i0, result + i0, i1 - i0, par); }, n);
+}
+
+bool ff::ParallelEvaluator::intensity(const Prism& p, const C3* q, double* result, size_t n,
+                                      const IntensityParameters& par)
+{
+    return runRecorded(
+        [&](size_t i0, size_t i1) { ff::intensity(p, q + i0, result + i0, i1 - i0, par); }, n);
+}
+
+bool ff::ParallelEvaluator::intensity(const Prism& p, const C3* q, float* result, size_t n,
+                                      const IntensityParameters& par)
+{
+    return runRecorded(
+        [&](size_t i0, size_t i1) { ff::intensity(p, q + i0, result + i0, i1 - i0, par); }, n);
+}
+
+//! If diagnostics are recorded on the calling thread, then each chunk is recorded in a
+//! sink of its own, which is then added to the caller's sink.
+
+bool ff::ParallelEvaluator::runRecorded(const std::function<void(size_t, size_t)>& job, size_t n)
+{
+    Diagnostics* const diag = Diagnostics::active();
+    if (!diag)
+        return run(job, n);
+    std::mutex mutex;
+    return run(
+        [&](size_t i0, size_t i1) {
+            Diagnostics chunk;
+            {
+                DiagnosticsScope scope(chunk);
+                job(i0, i1);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            *diag += chunk;
+        },
+        n);
+}
+
+bool ff::ParallelEvaluator::run(const std::function<void(size_t, size_t)>& job, size_t n,
+                                size_t chunk_size)
+{
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    if (chunk_size == 0)
+        chunk_size = m_chunk_size;
+
+    // contiguous shares, so that neighboring chunks, which tend to be in the same regime,
+    // are processed by the same thread unless stolen
+    const size_t n_chunks = (n + chunk_size - 1) / chunk_size;
+    const size_t N = nThreads();
+    for (size_t c = 0; c < n_chunks; ++c)
+        m_queues[c * N / n_chunks]->chunks.emplace_back(c * chunk_size,
+                                                        std::min(n, (c + 1) * chunk_size));
+    m_remaining = n_chunks;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_error = nullptr;
+        m_busy = m_threads.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    work(0);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_job = nullptr;
+    }
+
+    for (auto& queue : m_queues) // left over if cancelled
+        queue->chunks.clear();
+    // a request is consumed only by a batch that it stopped; one that came after the last
+    // chunk was started is kept for the next batch
+    if (m_remaining != 0 || m_error)
+        m_cancel = false;
+    if (m_error)
+        std::rethrow_exception(m_error);
+    return m_remaining == 0;
+}
+
+//! Takes the next chunk from the front of the own queue, or else steals from the back of
+//! another queue. Returns false if all queues are empty.
+
+bool ff::ParallelEvaluator::pop(size_t id, std::pair<size_t, size_t>& chunk)
+{
+    const size_t N = nThreads();
+    {
+        Queue& own = *m_queues[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < N; ++k) {
+        Queue& victim = *m_queues[(id + k) % N];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Processes chunks until all queues are empty or the batch is cancelled.
+
+void ff::ParallelEvaluator::work(size_t id)
+{
+    std::pair<size_t, size_t> chunk;
+    while (!m_cancel && pop(id, chunk)) {
+        try {
+            (*m_job)(chunk.first, chunk.second);
+            --m_remaining;
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+                m_error = std::current_exception();
+            m_cancel = true;
+        }
+    }
+}
+
+//! Main function of spawned thread id: waits for a batch, works on it, reports completion.
+
+void ff::ParallelEvaluator::loop(size_t id)
+{
+    size_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+        }
+        work(id);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+}
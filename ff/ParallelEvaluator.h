@@ -0,0 +1,121 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/ParallelEvaluator.h
+//! @brief     Defines class ParallelEvaluator.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_PARALLELEVALUATOR_H
+#define FORMFACTOR_FF_PARALLELEVALUATOR_H
+
+#include <ff/Intensity.h>
+#include <heinz/Complex.h>
+#include <heinz/Vectors3D.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ff {
+
+class Polyhedron;
+class Prism;
+
+//! Evaluates form factors for large arrays of wavevectors on a pool of threads.
+
+//! The wavevector array is cut into chunks of chunkSize() entries. Each thread starts with a
+//! contiguous share of the chunks; when done with its own share, it steals chunks from the
+//! others. Therefore the load stays balanced even though chunks in the series regime cost
+//! very differently from chunks in the analytic regime. Each chunk is handed to the batch
+//! evaluation of Polyhedron or Prism, so results are identical to serial batch evaluation.
+//!
+//! The calling thread takes part in the work, so nThreads()-1 threads are spawned. One
+//! evaluator runs one batch at a time; cancel() may be called from any thread. If a
+//! DiagnosticsScope is active on the calling thread, then the evaluations of all threads
+//! are recorded in its sink.
+
+class ParallelEvaluator {
+public:
+    //! n_threads=0 means one thread per hardware thread.
+    explicit ParallelEvaluator(size_t n_threads = 0, size_t chunk_size = 64);
+    ParallelEvaluator(const ParallelEvaluator&) = delete;
+    ~ParallelEvaluator();
+
+    size_t nThreads() const { return m_queues.size(); }
+    size_t chunkSize() const { return m_chunk_size; }
+
+    //! Computes result[i] = F(q[i]) for i < n. Returns false if cancelled before completion.
+    bool formfactor(const Polyhedron& p, const C3* q, complex_t* result, size_t n);
+    bool formfactor(const Prism& p, const C3* q, complex_t* result, size_t n);
+    //! Computes result[i*nz+j] for the grid qxy x qz, see Prism::formfactor_grid, in chunks
+    //! of chunkSize() in-plane wavevectors. Returns false if cancelled before completion.
+    bool formfactor_grid(const Prism& p, const C3* qxy, size_t nxy, const complex_t* qz,
+                         size_t nz, complex_t* result);
+
+    //! Computes result[i] = I(q[i]) for i < n, see ff::intensity. Returns false if cancelled
+    //! before completion.
+    bool intensity(const Polyhedron& p, const C3* q, double* result, size_t n,
+                   const IntensityParameters& par = {});
+    bool intensity(const Polyhedron& p, const C3* q, float* result, size_t n,
+                   const IntensityParameters& par = {});
+    bool intensity(const Prism& p, const C3* q, double* result, size_t n,
+                   const IntensityParameters& par = {});
+    bool intensity(const Prism& p, const C3* q, float* result, size_t n,
+                   const IntensityParameters& par = {});
+
+    //! Calls job(begin, end) for chunks that cover [0, n). Returns false if cancelled before
+    //! completion. Exceptions thrown by job cancel the batch and are rethrown here.
+    //! chunk_size=0 means chunkSize().
+    bool run(const std::function<void(size_t, size_t)>& job, size_t n, size_t chunk_size = 0);
+
+    //! Lets the current batch, or else the next one, return early. Chunks already started
+    //! are finished; results of chunks not started are left untouched. The request is
+    //! cleared by the batch that it stops.
+    void cancel() { m_cancel = true; }
+
+private:
+    //! Chunks assigned to one thread, as index ranges [begin, end).
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::pair<size_t, size_t>> chunks;
+    };
+
+    size_t m_chunk_size;
+    std::vector<std::unique_ptr<Queue>> m_queues; //!< one per thread, [0] for the caller
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_run_mutex; //!< serializes calls of run
+    std::mutex m_mutex;     //!< guards the following fields
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t, size_t)>* m_job = nullptr;
+    size_t m_generation = 0; //!< incremented for each batch
+    size_t m_busy = 0;       //!< number of spawned threads still working on the current batch
+    bool m_stop = false;
+    std::exception_ptr m_error;
+
+    std::atomic<bool> m_cancel{false};
+    std::atomic<size_t> m_remaining{0}; //!< chunks not yet completed
+
+    bool runRecorded(const std::function<void(size_t, size_t)>& job, size_t n);
+    bool pop(size_t id, std::pair<size_t, size_t>& chunk);
+    void work(size_t id);
+    void loop(size_t id);
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_PARALLELEVALUATOR_H
@@ -22,20 +22,24 @@ namespace ff::penta {
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology Decahedron::topology()
-
+constexpr StaticTopology<10, 3> decahedronTopology{
+    {{{0, 1, 5}, false}, 
+     {{1, 2, 5}, false}, 
+     {{2, 3, 5}, false}, 
+     {{3, 4, 5}, false}, 
+     {{4, 0, 5}, false}, 
+     {{1, 0, 6}, false}, 
+     {{2, 1, 6}, false}, 
+     {{3, 2, 6}, false}, 
+     {{4, 3, 6}, false}, 
+     {{0, 4, 6}, false}},
+    false};
+static_assert(decahedronTopology.isValid(), "inconsistent topology of Decahedron");
+
+const ff::PolyhedralTopology& Decahedron::topology()
 {
-    return {{{{0, 1, 5}, false}, 
-             {{1, 2, 5}, false}, 
-             {{2, 3, 5}, false}, 
-             {{3, 4, 5}, false}, 
-             {{4, 0, 5}, false}, 
-             {{1, 0, 6}, false}, 
-             {{2, 1, 6}, false}, 
-             {{3, 2, 6}, false}, 
-             {{4, 3, 6}, false}, 
-             {{0, 4, 6}, false}},
-            false};
+    static const ff::PolyhedralTopology result = decahedronTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Decahedron::vertices(const double edge)
@@ -57,27 +61,52 @@ std::vector<R3> Decahedron::vertices(const double edge)
             {0., 0., -height}};
 }
 
-Decahedron::Decahedron(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Decahedron::Decahedron(const double edge) : Decahedron(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Decahedron::Decahedron(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // D_5h
+    setPointGroup(group);
+}
+
+void Decahedron::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Decahedron::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 //  ************************************************************************************************
 //  Elongated Decahedron (decahedron with added parameter for anisotropy)
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology ElongatedDecahedron::topology()
-
+constexpr StaticTopology<10, 3> elongatedDecahedronTopology{
+    {{{0, 1, 5}, false}, 
+     {{1, 2, 5}, false}, 
+     {{2, 3, 5}, false}, 
+     {{3, 4, 5}, false}, 
+     {{4, 0, 5}, false}, 
+     {{1, 0, 6}, false}, 
+     {{2, 1, 6}, false}, 
+     {{3, 2, 6}, false}, 
+     {{4, 3, 6}, false}, 
+     {{0, 4, 6}, false}},
+    false};
+static_assert(elongatedDecahedronTopology.isValid(), "inconsistent topology of ElongatedDecahedron");
+
+const ff::PolyhedralTopology& ElongatedDecahedron::topology()
 {
-    return {{{{0, 1, 5}, false}, 
-             {{1, 2, 5}, false}, 
-             {{2, 3, 5}, false}, 
-             {{3, 4, 5}, false}, 
-             {{4, 0, 5}, false}, 
-             {{1, 0, 6}, false}, 
-             {{2, 1, 6}, false}, 
-             {{3, 2, 6}, false}, 
-             {{4, 3, 6}, false}, 
-             {{0, 4, 6}, false}},
-            false};
+    static const ff::PolyhedralTopology result = elongatedDecahedronTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> ElongatedDecahedron::vertices2(const double edge, const double height)
@@ -99,33 +128,58 @@ std::vector<R3> ElongatedDecahedron::vertices2(const double edge, const double h
             {0., 0., -h}};
 }
 
-ElongatedDecahedron::ElongatedDecahedron(const double edge, const double height) : ff::Polyhedron(topology(), vertices2(edge, height)) {}
+ElongatedDecahedron::ElongatedDecahedron(const double edge, const double height) : ElongatedDecahedron(std::nothrow, edge, height)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+ElongatedDecahedron::ElongatedDecahedron(std::nothrow_t, const double edge, const double height)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices2(edge, height))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices2(1., 2.)); // D_5h
+    setPointGroup(group);
+}
+
+void ElongatedDecahedron::setParameters(const double edge, const double height)
+{
+    setShapeVertices(vertices2(edge, height));
+}
+
+ff::Outcome ElongatedDecahedron::trySetParameters(const double edge, const double height)
+{
+    return trySetShapeVertices(vertices2(edge, height));
+}
 
 //  ************************************************************************************************
 //  Pentagonal Bifrustum
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology PentagonalBifrustum::topology()
-
+constexpr StaticTopology<12, 5> pentagonalBifrustumTopology{
+    {//Top face
+     {{5, 6, 7, 8, 9}, false},
+     //First row of faces
+     {{0, 1, 6, 5}, false}, 
+     {{1, 2, 7, 6}, false}, 
+     {{2, 3, 8, 7}, false}, 
+     {{3, 4, 9, 8}, false}, 
+     {{4, 0, 5, 9}, false},
+     //Second row of faces 
+     {{1, 0, 10, 11}, false}, 
+     {{2, 1, 11, 12}, false}, 
+     {{3, 2, 12, 13}, false}, 
+     {{4, 3, 13, 14}, false}, 
+     {{0, 4, 14, 10}, false},
+     //Bottom face
+     {{14, 13, 12, 11, 10}, false}},
+    false};
+static_assert(pentagonalBifrustumTopology.isValid(), "inconsistent topology of PentagonalBifrustum");
+
+const ff::PolyhedralTopology& PentagonalBifrustum::topology()
 {
-    return {{//Top face
-             {{5, 6, 7, 8, 9}, false},
-             //First row of faces
-             {{0, 1, 6, 5}, false}, 
-             {{1, 2, 7, 6}, false}, 
-             {{2, 3, 8, 7}, false}, 
-             {{3, 4, 9, 8}, false}, 
-             {{4, 0, 5, 9}, false},
-             //Second row of faces 
-             {{1, 0, 10, 11}, false}, 
-             {{2, 1, 11, 12}, false}, 
-             {{3, 2, 12, 13}, false}, 
-             {{4, 3, 13, 14}, false}, 
-             {{0, 4, 14, 10}, false},
-             //Bottom face
-             {{14, 13, 12, 11, 10}, false}},
-            false};
+    static const ff::PolyhedralTopology result = pentagonalBifrustumTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> PentagonalBifrustum::vertices3(const double edge, const double height, const double trunc)
@@ -159,7 +213,28 @@ std::vector<R3> PentagonalBifrustum::vertices3(const double edge, const double h
             {ac5*(1.-z),-as5*(1.-z), -z*h},};
 }
 
-PentagonalBifrustum::PentagonalBifrustum(const double edge, const double height, const double trunc) : ff::Polyhedron(topology(), vertices3(edge, height, trunc)) {}
+PentagonalBifrustum::PentagonalBifrustum(const double edge, const double height, const double trunc) : PentagonalBifrustum(std::nothrow, edge, height, trunc)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+PentagonalBifrustum::PentagonalBifrustum(std::nothrow_t, const double edge, const double height, const double trunc)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices3(edge, height, trunc))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices3(1., 1., .5)); // D_5h
+    setPointGroup(group);
+}
+
+void PentagonalBifrustum::setParameters(const double edge, const double height, const double trunc)
+{
+    setShapeVertices(vertices3(edge, height, trunc));
+}
+
+ff::Outcome PentagonalBifrustum::trySetParameters(const double edge, const double height, const double trunc)
+{
+    return trySetShapeVertices(vertices3(edge, height, trunc));
+}
 
 //  ************************************************************************************************
 //  Capped Pentagonal Prism (nanorods)
@@ -167,28 +242,32 @@ PentagonalBifrustum::PentagonalBifrustum(const double edge, const double height,
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology CappedPentagonalPrism::topology()
-
+constexpr StaticTopology<15, 4> cappedPentagonalPrismTopology{
+    {//Top Pyramid
+     {{0, 1, 10}, false},
+     {{1, 2, 10}, false},
+     {{2, 3, 10}, false},
+     {{3, 4, 10}, false},
+     {{4, 0, 10}, false},
+     //Central Prism
+     {{5, 6, 1, 0}, true},
+     {{6, 7, 2, 1}, true},
+     {{7, 8, 3, 2}, true},
+     {{8, 9, 4, 3}, true},
+     {{9, 5, 0, 4}, true},
+     //Bottom Pyramid}
+     {{6, 5, 11}, false},
+     {{7, 6, 11}, false},
+     {{8, 7, 11}, false},
+     {{9, 8, 11}, false},
+     {{5, 9, 11}, false}},
+    false};
+static_assert(cappedPentagonalPrismTopology.isValid(), "inconsistent topology of CappedPentagonalPrism");
+
+const ff::PolyhedralTopology& CappedPentagonalPrism::topology()
 {
-    return {{//Top Pyramid
-             {{0, 1, 10}, false},
-             {{1, 2, 10}, false},
-             {{2, 3, 10}, false},
-             {{3, 4, 10}, false},
-             {{4, 0, 10}, false},
-             //Central Prism
-             {{5, 6, 1, 0}, true},
-             {{6, 7, 2, 1}, true},
-             {{7, 8, 3, 2}, true},
-             {{8, 9, 4, 3}, true},
-             {{9, 5, 0, 4}, true},
-             //Bottom Pyramid}
-             {{6, 5, 11}, false},
-             {{7, 6, 11}, false},
-             {{8, 7, 11}, false},
-             {{9, 8, 11}, false},
-             {{5, 9, 11}, false}},
-            false};
+    static const ff::PolyhedralTopology result = cappedPentagonalPrismTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> CappedPentagonalPrism::vertices3(const double edge, const double height, const double capsize)
@@ -220,6 +299,27 @@ std::vector<R3> CappedPentagonalPrism::vertices3(const double edge, const double
             {0., 0., -h-z}};
 }
 
-CappedPentagonalPrism::CappedPentagonalPrism(const double edge, const double height, const double capsize) : ff::Polyhedron(topology(), vertices3(edge, height, capsize)) {}
+CappedPentagonalPrism::CappedPentagonalPrism(const double edge, const double height, const double capsize) : CappedPentagonalPrism(std::nothrow, edge, height, capsize)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+CappedPentagonalPrism::CappedPentagonalPrism(std::nothrow_t, const double edge, const double height, const double capsize)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices3(edge, height, capsize))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices3(1., 2., .5)); // D_5h
+    setPointGroup(group);
+}
+
+void CappedPentagonalPrism::setParameters(const double edge, const double height, const double capsize)
+{
+    setShapeVertices(vertices3(edge, height, capsize));
+}
+
+ff::Outcome CappedPentagonalPrism::trySetParameters(const double edge, const double height, const double capsize)
+{
+    return trySetShapeVertices(vertices3(edge, height, capsize));
+}
 
 } // namespace ff::penta
@@ -19,33 +19,45 @@ namespace ff::penta {
 // regular decahedron
 class Decahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Decahedron(const double edge);
+    Decahedron(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 
 };
 
 class ElongatedDecahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices2(const double edge, const double height);
     ElongatedDecahedron(const double edge, const double height);
+    ElongatedDecahedron(std::nothrow_t, const double edge, const double height);
+    void setParameters(const double edge, const double height);
+    ff::Outcome trySetParameters(const double edge, const double height);
 
 };
 
 class PentagonalBifrustum : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices3(const double edge, const double height, const double trunc);
     PentagonalBifrustum(const double edge, const double height, const double trunc);
+    PentagonalBifrustum(std::nothrow_t, const double edge, const double height, const double trunc);
+    void setParameters(const double edge, const double height, const double trunc);
+    ff::Outcome trySetParameters(const double edge, const double height, const double trunc);
 
 };
 
 class CappedPentagonalPrism : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices3(const double edge, const double height, const double capsize);
     CappedPentagonalPrism(const double edge, const double height, const double capsize);
+    CappedPentagonalPrism(std::nothrow_t, const double edge, const double height, const double capsize);
+    void setParameters(const double edge, const double height, const double capsize);
+    ff::Outcome trySetParameters(const double edge, const double height, const double capsize);
 
 };
 } // namespace ff::penta
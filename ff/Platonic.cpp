@@ -20,10 +20,15 @@ namespace ff::platonic {
 //  class Tetrahedron
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Tetrahedron::topology()
+constexpr StaticTopology<4, 3> tetrahedronTopology{
+    {{{2, 1, 0}, false}, {{0, 1, 3}, false}, {{1, 2, 3}, false}, {{2, 0, 3}, false}},
+    false};
+static_assert(tetrahedronTopology.isValid(), "inconsistent topology of Tetrahedron");
+
+const ff::PolyhedralTopology& Tetrahedron::topology()
 {
-    return {{{{2, 1, 0}, false}, {{0, 1, 3}, false}, {{1, 2, 3}, false}, {{2, 0, 3}, false}},
-            false};
+    static const ff::PolyhedralTopology result = tetrahedronTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Tetrahedron::vertices(const double edge)
@@ -38,23 +43,49 @@ std::vector<R3> Tetrahedron::vertices(const double edge)
     return {{-ac, as, -zcom}, {-ac, -as, -zcom}, {ah, 0., -zcom}, {0, 0., height - zcom}};
 }
 
-Tetrahedron::Tetrahedron(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Tetrahedron::Tetrahedron(const double edge) : Tetrahedron(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Tetrahedron::Tetrahedron(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // T_d
+    setPointGroup(group);
+}
+
+void Tetrahedron::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Tetrahedron::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 //  ************************************************************************************************
 //  class Octahedron
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Octahedron::topology()
+constexpr StaticTopology<8, 3> octahedronTopology{
+    {{{0, 2, 1}, false},
+     {{0, 3, 2}, false},
+     {{0, 4, 3}, false},
+     {{0, 1, 4}, false},
+     {{2, 3, 5}, false},
+     {{1, 2, 5}, false},
+     {{4, 1, 5}, false},
+     {{3, 4, 5}, false}},
+    true};
+static_assert(octahedronTopology.isValid(), "inconsistent topology of Octahedron");
+
+const ff::PolyhedralTopology& Octahedron::topology()
 {
-    return {{{{0, 2, 1}, false},
-             {{0, 3, 2}, false},
-             {{0, 4, 3}, false},
-             {{0, 1, 4}, false},
-             {{2, 3, 5}, false},
-             {{1, 2, 5}, false},
-             {{4, 1, 5}, false},
-             {{3, 4, 5}, false}},
-            true};
+    static const ff::PolyhedralTopology result = octahedronTopology.toTopology();
+    return result;
 }
 
 /// diagonal position: axes on vertices
@@ -74,31 +105,57 @@ std::vector<R3> Octahedron::vertices(const double edge)
     return {{0, 0, -h}, {a, -a, 0}, {a, a, 0}, {-a, a, 0}, {-a, -a, 0}, {0, 0, h}};
 }
 
-Octahedron::Octahedron(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Octahedron::Octahedron(const double edge) : Octahedron(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Octahedron::Octahedron(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // O_h
+    setPointGroup(group);
+}
+
+void Octahedron::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Octahedron::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 //  ************************************************************************************************
 //  class Dodecahedron
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Dodecahedron::topology()
-{
-    return {{// bottom:
-             {{0, 4, 3, 2, 1}, false},
-             // lower ring:
-             {{0, 5, 12, 9, 4}, false},
-             {{4, 9, 11, 8, 3}, false},
-             {{3, 8, 10, 7, 2}, false},
-             {{2, 7, 14, 6, 1}, false},
-             {{1, 6, 13, 5, 0}, false},
-             // upper ring:
-             {{8, 11, 16, 15, 10}, false},
-             {{9, 12, 17, 16, 11}, false},
-             {{5, 13, 18, 17, 12}, false},
-             {{6, 14, 19, 18, 13}, false},
-             {{7, 10, 15, 19, 14}, false},
-             // top:
-             {{15, 16, 17, 18, 19}, false}},
-            true};
+constexpr StaticTopology<12, 5> dodecahedronTopology{
+    {// bottom:
+     {{0, 4, 3, 2, 1}, false},
+     // lower ring:
+     {{0, 5, 12, 9, 4}, false},
+     {{4, 9, 11, 8, 3}, false},
+     {{3, 8, 10, 7, 2}, false},
+     {{2, 7, 14, 6, 1}, false},
+     {{1, 6, 13, 5, 0}, false},
+     // upper ring:
+     {{8, 11, 16, 15, 10}, false},
+     {{9, 12, 17, 16, 11}, false},
+     {{5, 13, 18, 17, 12}, false},
+     {{6, 14, 19, 18, 13}, false},
+     {{7, 10, 15, 19, 14}, false},
+     // top:
+     {{15, 16, 17, 18, 19}, false}},
+    true};
+static_assert(dodecahedronTopology.isValid(), "inconsistent topology of Dodecahedron");
+
+const ff::PolyhedralTopology& Dodecahedron::topology()
+{
+    static const ff::PolyhedralTopology result = dodecahedronTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Dodecahedron::vertices(const double a)
@@ -118,41 +175,67 @@ std::vector<R3> Dodecahedron::vertices(const double a)
             {-r6, 0, r7}, {-r1, -r5, r7}, {r4, -r3, r7},  {r4, r3, r7},    {-r1, r5, r7}};
 }
 
-Dodecahedron::Dodecahedron(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Dodecahedron::Dodecahedron(const double edge) : Dodecahedron(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Dodecahedron::Dodecahedron(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // I_h
+    setPointGroup(group);
+}
+
+void Dodecahedron::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Dodecahedron::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 //  ************************************************************************************************
 //  class Icosahedron
 //  ************************************************************************************************
 
-ff::PolyhedralTopology Icosahedron::topology()
-{
-    return {{// bottom:
-             {{0, 2, 1}, false},
-             // 1st row:
-             {{0, 5, 2}, false},
-             {{2, 3, 1}, false},
-             {{1, 4, 0}, false},
-             // 2nd row:
-             {{0, 6, 5}, false},
-             {{2, 5, 8}, false},
-             {{2, 8, 3}, false},
-             {{1, 3, 7}, false},
-             {{1, 7, 4}, false},
-             {{0, 4, 6}, false},
-             // 3rd row:
-             {{3, 8, 9}, false},
-             {{5, 11, 8}, false},
-             {{5, 6, 11}, false},
-             {{4, 10, 6}, false},
-             {{4, 7, 10}, false},
-             {{3, 9, 7}, false},
-             // 4th row:
-             {{8, 11, 9}, false},
-             {{6, 10, 11}, false},
-             {{7, 9, 10}, false},
-             // top:
-             {{9, 11, 10}, false}},
-            true};
+constexpr StaticTopology<20, 3> icosahedronTopology{
+    {// bottom:
+     {{0, 2, 1}, false},
+     // 1st row:
+     {{0, 5, 2}, false},
+     {{2, 3, 1}, false},
+     {{1, 4, 0}, false},
+     // 2nd row:
+     {{0, 6, 5}, false},
+     {{2, 5, 8}, false},
+     {{2, 8, 3}, false},
+     {{1, 3, 7}, false},
+     {{1, 7, 4}, false},
+     {{0, 4, 6}, false},
+     // 3rd row:
+     {{3, 8, 9}, false},
+     {{5, 11, 8}, false},
+     {{5, 6, 11}, false},
+     {{4, 10, 6}, false},
+     {{4, 7, 10}, false},
+     {{3, 9, 7}, false},
+     // 4th row:
+     {{8, 11, 9}, false},
+     {{6, 10, 11}, false},
+     {{7, 9, 10}, false},
+     // top:
+     {{9, 11, 10}, false}},
+    true};
+static_assert(icosahedronTopology.isValid(), "inconsistent topology of Icosahedron");
+
+const ff::PolyhedralTopology& Icosahedron::topology()
+{
+    static const ff::PolyhedralTopology result = icosahedronTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> Icosahedron::vertices(const double a)
@@ -170,6 +253,27 @@ std::vector<R3> Icosahedron::vertices(const double a)
             {-s3, -s7, s1}, {-s5, 0, s6},   {s2, s4, s6},    {s2, -s4, s6}};
 }
 
-Icosahedron::Icosahedron(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+Icosahedron::Icosahedron(const double edge) : Icosahedron(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+Icosahedron::Icosahedron(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // I_h
+    setPointGroup(group);
+}
+
+void Icosahedron::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome Icosahedron::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 } // namespace ff::platonic
@@ -18,30 +18,42 @@ namespace ff::platonic {
 
 class Tetrahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Tetrahedron(const double edge);
+    Tetrahedron(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 class Octahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Octahedron(const double edge);
+    Octahedron(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 class Dodecahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Dodecahedron(const double edge);
+    Dodecahedron(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 class Icosahedron : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     Icosahedron(const double edge);
+    Icosahedron(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 } // namespace ff::platonic
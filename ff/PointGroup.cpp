@@ -0,0 +1,272 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PointGroup.cpp
+//! @brief     Implements class PointGroup.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/PointGroup.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+//! Relative tolerance for matching transformed vertices, and for comparing elements.
+const double tol = 1e-9;
+
+using Matrix = ff::PointGroup::Matrix;
+
+double component(const R3& v, int i)
+{
+    return i == 0 ? v.x() : i == 1 ? v.y() : v.z();
+}
+
+Matrix identity()
+{
+    return {R3(1., 0., 0.), R3(0., 1., 0.), R3(0., 0., 1.)};
+}
+
+Matrix negative(const Matrix& g)
+{
+    return {-1. * g[0], -1. * g[1], -1. * g[2]};
+}
+
+double distance(const Matrix& a, const Matrix& b)
+{
+    return std::max({(a[0] - b[0]).mag(), (a[1] - b[1]).mag(), (a[2] - b[2]).mag()});
+}
+
+double determinant(const Matrix& g)
+{
+    return g[0].dot(g[1].cross(g[2]));
+}
+
+double trace(const Matrix& g)
+{
+    return g[0].x() + g[1].y() + g[2].z();
+}
+
+//! Rounds entries that are within rounding errors of 0, +-1/2, or +-1, so that signed
+//! permutations map wavevectors exactly onto each other.
+R3 snap(const R3& r)
+{
+    double c[3] = {r.x(), r.y(), r.z()};
+    for (double& x : c)
+        for (double v : {0., .5, -.5, 1., -1.})
+            if (std::abs(x - v) < 1e-12)
+                x = v;
+    return {c[0], c[1], c[2]};
+}
+
+//! Returns the unit normal of the mirror plane of reflection r.
+R3 mirrorNormal(const Matrix& r)
+{
+    // 1 - r = 2 n n^T; take its largest row
+    const Matrix d = {R3(1., 0., 0.) - r[0], R3(0., 1., 0.) - r[1], R3(0., 0., 1.) - r[2]};
+    const R3* best = &d[0];
+    for (const R3& row : d)
+        if (row.mag() > best->mag())
+            best = &row;
+    return best->unit();
+}
+
+} // namespace
+
+
+ff::PointGroup::PointGroup(bool inversion)
+    : PointGroup(inversion ? std::vector<Matrix>{identity(), negative(identity())}
+                           : std::vector<Matrix>{identity()})
+{
+}
+
+ff::PointGroup::PointGroup(const std::vector<Matrix>& elements)
+    : m_elements(elements)
+{
+    m_inversion = contains(negative(identity()));
+    computeTriangle();
+}
+
+//! Each element is determined by the images of three vertices that span space. Candidate
+//! images are vertices with the same norms and mutual scalar products. A candidate is
+//! accepted if the resulting matrix is orthogonal and maps all vertices onto vertices.
+
+ff::PointGroup ff::PointGroup::ofVertices(const std::vector<R3>& vertices)
+{
+    double scale = 0;
+    for (const R3& v : vertices)
+        scale = std::max(scale, v.mag());
+    const double eps = tol * scale;
+
+    // a well conditioned basis of three vertices
+    size_t b[3] = {0, 0, 0};
+    double best[3] = {0, 0, 0};
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const double m = vertices[i].mag();
+        if (m > best[0]) {
+            best[0] = m;
+            b[0] = i;
+        }
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const double m = vertices[b[0]].cross(vertices[i]).mag();
+        if (m > best[1]) {
+            best[1] = m;
+            b[1] = i;
+        }
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const double m = std::abs(vertices[b[0]].cross(vertices[b[1]]).dot(vertices[i]));
+        if (m > best[2]) {
+            best[2] = m;
+            b[2] = i;
+        }
+    }
+    if (!(best[2] > eps * scale * scale))
+        throw std::invalid_argument("PointGroup::ofVertices: vertices do not span space");
+    const R3& v0 = vertices[b[0]];
+    const R3& v1 = vertices[b[1]];
+    const R3& v2 = vertices[b[2]];
+    const double det = v0.dot(v1.cross(v2));
+    // rows of the inverse of the matrix with columns v0, v1, v2
+    const R3 inv[3] = {v1.cross(v2) / det, v2.cross(v0) / det, v0.cross(v1) / det};
+
+    const auto similar = [eps, scale](double a, double b) {
+        return std::abs(a - b) <= eps * scale;
+    };
+    const auto isVertex = [&vertices, eps](const R3& r) {
+        for (const R3& v : vertices)
+            if ((r - v).mag() <= eps)
+                return true;
+        return false;
+    };
+
+    std::vector<Matrix> elements;
+    for (const R3& w0 : vertices) {
+        if (!similar(w0.mag2(), v0.mag2()))
+            continue;
+        for (const R3& w1 : vertices) {
+            if (!similar(w1.mag2(), v1.mag2()) || !similar(w0.dot(w1), v0.dot(v1)))
+                continue;
+            for (const R3& w2 : vertices) {
+                if (!similar(w2.mag2(), v2.mag2()) || !similar(w0.dot(w2), v0.dot(v2))
+                    || !similar(w1.dot(w2), v1.dot(v2)))
+                    continue;
+                // g maps v_k to w_k
+                Matrix g;
+                for (int i = 0; i < 3; ++i)
+                    g[i] = snap(component(w0, i) * inv[0] + component(w1, i) * inv[1]
+                                + component(w2, i) * inv[2]);
+                bool orthogonal = true;
+                for (int i = 0; i < 3; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        orthogonal &= std::abs(g[i].dot(g[j]) - (i == j)) <= 1e-6;
+                if (!orthogonal)
+                    continue;
+                if (std::all_of(vertices.begin(), vertices.end(),
+                                [&g, &isVertex](const R3& v) { return isVertex(apply(g, v)); }))
+                    elements.push_back(g);
+            }
+        }
+    }
+    // the identity first
+    const auto id = std::min_element(
+        elements.begin(), elements.end(), [](const Matrix& a, const Matrix& b) {
+            return distance(a, identity()) < distance(b, identity());
+        });
+    std::rotate(elements.begin(), id, id + 1);
+    return PointGroup(elements);
+}
+
+R3 ff::PointGroup::apply(const Matrix& g, const R3& v)
+{
+    return {g[0].dot(v), g[1].dot(v), g[2].dot(v)};
+}
+
+bool ff::PointGroup::contains(const Matrix& g) const
+{
+    for (const Matrix& h : m_elements)
+        if (distance(g, h) <= tol)
+            return true;
+    return false;
+}
+
+bool ff::PointGroup::includes(const PointGroup& group) const
+{
+    if (&group == this)
+        return true;
+    for (const Matrix& g : group.m_elements)
+        if (!contains(g))
+            return false;
+    return true;
+}
+
+bool ff::PointGroup::fundamentalTriangle(std::array<R3, 3>& corners) const
+{
+    if (m_triangle.empty())
+        return false;
+    std::copy(m_triangle.begin(), m_triangle.end(), corners.begin());
+    return true;
+}
+
+//! The mirror planes of the Laue group cut the sphere into chambers. A chamber is a
+//! fundamental domain if it is a triangle with area 4*pi/laueOrder(). Its corners are the
+//! intersections of pairs of mirror planes that lie on the closed side of all mirrors.
+
+void ff::PointGroup::computeTriangle()
+{
+    m_triangle.clear();
+    std::vector<R3> normals;
+    for (const Matrix& g : m_elements)
+        for (const Matrix& r : {g, negative(g)})
+            if (determinant(r) < 0 && std::abs(trace(r) - 1) <= tol) {
+                const R3 n = mirrorNormal(r);
+                if (std::none_of(normals.begin(), normals.end(), [&n](const R3& m) {
+                        return n.cross(m).mag() <= tol;
+                    }))
+                    normals.push_back(n);
+            }
+
+    // orient all mirrors towards a direction that is off all mirror planes
+    const R3 x0 = R3(0.2718281828, 0.3141592654, 0.9092974268).unit();
+    for (R3& n : normals) {
+        if (std::abs(n.dot(x0)) < 1e-6)
+            return;
+        if (n.dot(x0) < 0)
+            n = -1. * n;
+    }
+
+    std::vector<R3> corners;
+    for (size_t a = 0; a < normals.size(); ++a)
+        for (size_t b = a + 1; b < normals.size(); ++b) {
+            const R3 v = normals[a].cross(normals[b]).unit();
+            for (const R3& w : {v, -1. * v}) {
+                if (std::any_of(normals.begin(), normals.end(),
+                                [&w](const R3& n) { return n.dot(w) < -tol; }))
+                    continue;
+                if (std::none_of(corners.begin(), corners.end(),
+                                 [&w](const R3& c) { return (c - w).mag() <= 1e-6; }))
+                    corners.push_back(w);
+            }
+        }
+    if (corners.size() != 3)
+        return;
+
+    // area of the spherical triangle, by the formula of Van Oosterom and Strackee
+    const R3& A = corners[0];
+    const R3& B = corners[1];
+    const R3& C = corners[2];
+    const double area =
+        2 * std::atan2(std::abs(A.dot(B.cross(C))), 1 + A.dot(B) + B.dot(C) + C.dot(A));
+    if (std::abs(area - 4 * pi / laueOrder()) <= 1e-9)
+        m_triangle = corners;
+}
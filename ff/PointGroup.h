@@ -0,0 +1,72 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PointGroup.h
+//! @brief     Defines class PointGroup.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_POINTGROUP_H
+#define FORMFACTOR_FF_POINTGROUP_H
+
+#include <heinz/Vectors3D.h>
+#include <array>
+#include <vector>
+
+namespace ff {
+
+//! A finite group of orthogonal transforms that leave a polyhedron invariant, so that
+//! F(g*q) = F(q) for all elements g.
+
+//! For real q, also F(-q) = conj(F(q)). Therefore F is determined by its values in a
+//! fundamental domain of the Laue group, generated by the point group and the inversion.
+//! For all built-in shapes, the Laue group is generated by reflections, and its fundamental
+//! domain is a spherical triangle.
+
+class PointGroup {
+public:
+    //! Rows of an orthogonal matrix.
+    using Matrix = std::array<R3, 3>;
+
+    //! The trivial group, or the group {1, -1} if inversion is true.
+    explicit PointGroup(bool inversion = false);
+
+    //! Returns the group of all orthogonal transforms that map the vertex set onto itself.
+    //! For a convex polyhedron, this is the point group with respect to the origin.
+    static PointGroup ofVertices(const std::vector<R3>& vertices);
+
+    //! Returns g*v.
+    static R3 apply(const Matrix& g, const R3& v);
+
+    size_t order() const { return m_elements.size(); }
+    //! Elements, starting with the identity.
+    const std::vector<Matrix>& elements() const { return m_elements; }
+    bool hasInversion() const { return m_inversion; }
+    //! Order of the Laue group.
+    size_t laueOrder() const { return m_inversion ? order() : 2 * order(); }
+    //! Returns true if all elements of group are contained in this one.
+    bool includes(const PointGroup& group) const;
+
+    //! Returns true, and sets corners to the unit vectors that span a spherical triangle that
+    //! is a fundamental domain of the Laue group, if there is such a triangle.
+    bool fundamentalTriangle(std::array<R3, 3>& corners) const;
+
+private:
+    std::vector<Matrix> m_elements;
+    bool m_inversion;
+    std::vector<R3> m_triangle; //!< corners of the fundamental triangle, or empty
+
+    explicit PointGroup(const std::vector<Matrix>& elements);
+    bool contains(const Matrix& g) const;
+    void computeTriangle();
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_POINTGROUP_H
@@ -0,0 +1,125 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralArrays.cpp
+//! @brief     Implements class PolyhedralArrays.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/PolyhedralArrays.h"
+#include <stdexcept>
+
+ff::PolyhedralArrays::PolyhedralArrays(const std::vector<PolyhedralFace>& faces,
+                                       const std::vector<size_t>& edgeIds)
+{
+    size_t NE = 0;
+    for (const PolyhedralFace& Gk : faces)
+        NE += Gk.nEdges();
+    for (auto* v : {&nx, &ny, &nz, &rperp, &area, &radius2d})
+        v->reserve(faces.size());
+    for (auto* v : {&Ex, &Ey, &Ez, &Rx, &Ry, &Rz})
+        v->reserve(NE);
+    symS2.reserve(faces.size());
+    edgeBegin.reserve(faces.size() + 1);
+
+    for (const PolyhedralFace& Gk : faces) {
+        const R3 n = Gk.normal();
+        nx.push_back(n.x());
+        ny.push_back(n.y());
+        nz.push_back(n.z());
+        rperp.push_back(Gk.rperp());
+        area.push_back(Gk.area());
+        radius2d.push_back(Gk.radius2d());
+        symS2.push_back(Gk.symmetry_S2());
+        edgeBegin.push_back(Ex.size());
+        for (size_t i = 0; i < Gk.nEdges(); ++i) {
+            const R3 E = Gk.E(i);
+            const R3 R = Gk.R(i);
+            Ex.push_back(E.x());
+            Ey.push_back(E.y());
+            Ez.push_back(E.z());
+            Rx.push_back(R.x());
+            Ry.push_back(R.y());
+            Rz.push_back(R.z());
+        }
+    }
+    edgeBegin.push_back(Ex.size());
+    linkEdges(edgeIds);
+}
+
+void ff::PolyhedralArrays::assign(const std::vector<PolyhedralFace>& faces)
+{
+    if (faces.size() != nFaces())
+        throw std::logic_error("PolyhedralArrays::assign: number of faces has changed");
+    for (size_t k = 0; k < faces.size(); ++k) {
+        const PolyhedralFace& Gk = faces[k];
+        if (Gk.nEdges() != edgeBegin[k + 1] - edgeBegin[k])
+            throw std::logic_error("PolyhedralArrays::assign: number of edges has changed");
+        const R3 n = Gk.normal();
+        nx[k] = n.x();
+        ny[k] = n.y();
+        nz[k] = n.z();
+        rperp[k] = Gk.rperp();
+        area[k] = Gk.area();
+        radius2d[k] = Gk.radius2d();
+        symS2[k] = Gk.symmetry_S2();
+        for (size_t i = 0; i < Gk.nEdges(); ++i) {
+            const size_t ii = edgeBegin[k] + i;
+            const R3 E = Gk.E(i);
+            const R3 R = Gk.R(i);
+            Ex[ii] = E.x();
+            Ey[ii] = E.y();
+            Ez[ii] = E.z();
+            Rx[ii] = R.x();
+            Ry[ii] = R.y();
+            Rz[ii] = R.z();
+        }
+    }
+    copySharedEdges();
+}
+
+void ff::PolyhedralArrays::linkEdges(const std::vector<size_t>& edgeIds)
+{
+    if (!edgeIds.empty() && edgeIds.size() != nEdges())
+        throw std::logic_error("PolyhedralArrays: number of edge identifiers differs from "
+                               "number of edges");
+    std::vector<size_t> slot(nEdges(), nEdges()); // shared edge index by identifier
+    sharedEdge.assign(nEdges(), 0);
+    sharedSource.clear();
+    for (size_t k = 0; k < nFaces(); ++k) {
+        if (symS2[k])
+            continue;
+        for (size_t j = edgeBegin[k]; j < edgeBegin[k + 1]; ++j) {
+            const size_t id = edgeIds.empty() ? j : edgeIds[j];
+            if (id >= nEdges())
+                throw std::logic_error("PolyhedralArrays: edge identifier out of range");
+            if (slot[id] == nEdges()) {
+                slot[id] = sharedSource.size();
+                sharedSource.push_back(j);
+            }
+            sharedEdge[j] = slot[id];
+        }
+    }
+    for (auto* v : {&sEx, &sEy, &sEz, &sRx, &sRy, &sRz})
+        v->resize(sharedSource.size());
+    copySharedEdges();
+}
+
+void ff::PolyhedralArrays::copySharedEdges()
+{
+    for (size_t s = 0; s < sharedSource.size(); ++s) {
+        const size_t i = sharedSource[s];
+        sEx[s] = Ex[i];
+        sEy[s] = Ey[i];
+        sEz[s] = Ez[i];
+        sRx[s] = Rx[i];
+        sRy[s] = Ry[i];
+        sRz[s] = Rz[i];
+    }
+}
@@ -0,0 +1,136 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralArrays.h
+//! @brief     Defines class PolyhedralArrays.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_POLYHEDRALARRAYS_H
+#define FORMFACTOR_FF_POLYHEDRALARRAYS_H
+
+#include <ff/PolyhedralComponents.h>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace ff_aux {
+
+//! Allocator that aligns storage to 64 bytes, the width of an AVX-512 register.
+
+template <class T> class AlignedAllocator {
+public:
+    using value_type = T;
+    static constexpr std::size_t alignment = 64;
+
+    AlignedAllocator() noexcept = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+    template <class U> bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+};
+
+template <class T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace ff_aux
+
+
+namespace ff {
+
+//! Faces and edges of a polyhedron, flattened into structure-of-arrays storage.
+
+//! Holds the same data as a vector of PolyhedralFace, but each coordinate of all faces,
+//! resp. of all edges, is stored in one contiguous, SIMD-aligned array.
+//! The edges of face k have indices edgeBegin[k] to edgeBegin[k+1]-1.
+//!
+//! Each edge of the polyhedron borders two faces. The edges of faces without symmetry S2
+//! are also listed once in the shared edge arrays, so that the factors sinc(q*E) and
+//! exp(i*q*R) need to be computed only once per edge. Which edges coincide is given by the
+//! caller as edge identifiers. With symmetry Ci, an edge and its inverse are given the same
+//! identifier, since sinc(q*E)*cos(q*R) is the same for both.
+
+class PolyhedralArrays {
+public:
+    class Face;
+
+    PolyhedralArrays() = default;
+    //! Edges j with equal edgeIds[j] are listed once in the shared edge arrays. If edgeIds
+    //! is empty, no edges are shared.
+    PolyhedralArrays(const std::vector<PolyhedralFace>& faces,
+                     const std::vector<size_t>& edgeIds = {});
+
+    //! Overwrites all entries in place; faces must have the same edge counts as before.
+    void assign(const std::vector<PolyhedralFace>& faces);
+
+    size_t nFaces() const { return area.size(); }
+    size_t nEdges() const { return Ex.size(); }
+    size_t nSharedEdges() const { return sEx.size(); }
+    Face face(size_t k) const;
+
+    // per face:
+    ff_aux::AlignedVector<double> nx, ny, nz; //!< normal vector
+    ff_aux::AlignedVector<double> rperp;      //!< distance of face plane from origin
+    ff_aux::AlignedVector<double> area;
+    ff_aux::AlignedVector<double> radius2d; //!< radius of enclosing cylinder
+    std::vector<char> symS2;                //!< true if face has perpendicular two-fold axis
+    std::vector<size_t> edgeBegin;          //!< index of first edge, plus final end index
+
+    // per edge:
+    ff_aux::AlignedVector<double> Ex, Ey, Ez; //!< vector from edge midpoint to upper vertex
+    ff_aux::AlignedVector<double> Rx, Ry, Rz; //!< position of edge midpoint
+    std::vector<size_t> sharedEdge;           //!< index of shared edge; unused for faces with S2
+
+    // per shared edge:
+    ff_aux::AlignedVector<double> sEx, sEy, sEz; //!< E of one of the edges it stands for
+    ff_aux::AlignedVector<double> sRx, sRy, sRz; //!< R of the same edge
+    std::vector<size_t> sharedSource;            //!< index of the same edge
+
+private:
+    void linkEdges(const std::vector<size_t>& edgeIds);
+    void copySharedEdges();
+};
+
+//! One face of PolyhedralArrays, with the same accessors as PolyhedralFace.
+
+class PolyhedralArrays::Face {
+public:
+    Face(const PolyhedralArrays& a, size_t k) : m_a(a), m_k(k), m_begin(a.edgeBegin[k]) {}
+
+    R3 normal() const { return {m_a.nx[m_k], m_a.ny[m_k], m_a.nz[m_k]}; }
+    double rperp() const { return m_a.rperp[m_k]; }
+    double area() const { return m_a.area[m_k]; }
+    double radius2d() const { return m_a.radius2d[m_k]; }
+    bool symmetry_S2() const { return m_a.symS2[m_k]; }
+    size_t nEdges() const { return m_a.edgeBegin[m_k + 1] - m_begin; }
+    R3 E(size_t i) const { return {m_a.Ex[m_begin + i], m_a.Ey[m_begin + i], m_a.Ez[m_begin + i]}; }
+    R3 R(size_t i) const { return {m_a.Rx[m_begin + i], m_a.Ry[m_begin + i], m_a.Rz[m_begin + i]}; }
+    size_t shared(size_t i) const { return m_a.sharedEdge[m_begin + i]; }
+
+private:
+    const PolyhedralArrays& m_a;
+    const size_t m_k;
+    const size_t m_begin;
+};
+
+inline PolyhedralArrays::Face PolyhedralArrays::face(size_t k) const
+{
+    return {*this, k};
+}
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_POLYHEDRALARRAYS_H
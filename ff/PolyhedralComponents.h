@@ -15,27 +15,14 @@
 #ifndef FORMFACTOR_FF_POLYHEDRALCOMPONENTS_H
 #define FORMFACTOR_FF_POLYHEDRALCOMPONENTS_H
 
+#include "ff/Accuracy.h"
+#include "ff/Status.h"
 #include <heinz/Complex.h>
 #include <heinz/Vectors3D.h>
 #include <vector>
 
 namespace ff {
 
-#ifdef ALGORITHM_DIAGNOSTIC
-#include <string>
-
-struct PolyhedralDiagnosis {
-    int algo;
-    int order;
-    std::string msg;
-    void reset();
-    std::string message() const;
-    bool operator==(const PolyhedralDiagnosis&) const;
-    bool operator!=(const PolyhedralDiagnosis&) const;
-};
-inline PolyhedralDiagnosis polyhedralDiagnosis;
-#endif
-
 //! One edge of a polygon, for form factor computation.
 
 class PolyhedralEdge {
@@ -61,6 +48,11 @@ public:
     static double diameter(const std::vector<R3>& V);
 
     PolyhedralFace(const std::vector<R3>& _V = std::vector<R3>(), bool _sym_S2 = false);
+    //! Same as above, but records failure in outcome instead of throwing.
+    PolyhedralFace(const std::vector<R3>& _V, bool _sym_S2, Outcome& outcome);
+
+    void setVertices(const std::vector<R3>& V);
+    Outcome trySetVertices(const std::vector<R3>& V);
 
     double area() const { return m_area; }
     double pyramidalVolume() const { return m_rperp * m_area / 3; }
@@ -68,16 +60,26 @@ public:
     //! Returns conj(q)*normal [BasicVector3D::dot is antilinear in 'this' argument]
     complex_t normalProjectionConj(C3 q) const { return q.dot(m_normal); }
     complex_t ff_n(int n, C3 q) const;
-    complex_t ff(C3 q, bool sym_Ci) const;
-    complex_t ff_2D(C3 qpa) const;
-    complex_t ff_2D_direct(C3 qpa) const;   // for TestTriangle
-    complex_t ff_2D_expanded(C3 qpa) const; // for TestTriangle
+    complex_t ff_n(int n, R3 q) const;
+    complex_t ff(C3 q, bool sym_Ci, const Accuracy& acc = Accuracy()) const;
+    complex_t ff(R3 q, bool sym_Ci, const Accuracy& acc = Accuracy()) const;
+    complex_t ff_2D(C3 qpa, const Accuracy& acc = Accuracy()) const;
+    complex_t ff_2D(R3 qpa, const Accuracy& acc = Accuracy()) const;
+    complex_t ff_2D_direct(C3 qpa) const;                                     // for TestTriangle
+    complex_t ff_2D_expanded(C3 qpa, const Accuracy& acc = Accuracy()) const; // for TestTriangle
     void assert_Ci(const PolyhedralFace& other) const;
+    Outcome check_Ci(const PolyhedralFace& other) const;
 
-private:
-    static double qpa_limit_series; //!< determines when use power series
-    static int n_limit_series;
+    // accessors for the evaluation kernels and for PolyhedralArrays
+    R3 normal() const { return m_normal; }
+    double rperp() const { return m_rperp; }
+    double radius2d() const { return m_radius_2d; }
+    bool symmetry_S2() const { return sym_S2; }
+    size_t nEdges() const { return edges.size(); }
+    R3 E(size_t i) const { return edges[i].E(); }
+    R3 R(size_t i) const { return edges[i].R(); }
 
+private:
     bool sym_S2; //!< if true, then edges obtainable by inversion are not provided
     std::vector<PolyhedralEdge> edges;
     double m_area;
@@ -86,10 +88,7 @@ private:
     double m_radius_2d; //!< radius of enclosing cylinder
     double m_radius_3d; //!< radius of enclosing sphere
 
-    void decompose_q(C3 q, complex_t& qperp, C3& qpa) const;
-    complex_t ff_n_core(int m, C3 qpa, complex_t qperp) const;
-    complex_t edge_sum_ff(C3 q, C3 qpa, bool sym_Ci) const;
-    complex_t expansion(complex_t fac_even, complex_t fac_odd, C3 qpa, double abslevel) const;
+    Outcome assign(const std::vector<R3>& V, bool validate);
 };
 
 } // namespace ff
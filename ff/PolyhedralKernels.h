@@ -0,0 +1,472 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralKernels.h
+//! @brief     Defines face-level kernels of the polyhedral form factor computation.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! For internal use in PolyhedralComponents.cpp, Polyhedron.cpp and Prism.cpp.
+//!
+//! The kernels are templated on the storage of one polygonal face. The face class must provide
+//! normal(), rperp(), area(), radius2d(), symmetry_S2(), nEdges(), E(i) and R(i).
+//! This is the case for PolyhedralFace, which owns its edges, and for PolyhedralArrays::Face,
+//! which refers to the flattened face and edge arrays of a Polyhedron, and also provides
+//! shared(i), the index of edge i among the shared edges of the polyhedron.
+
+#ifndef FORMFACTOR_FF_POLYHEDRALKERNELS_H
+#define FORMFACTOR_FF_POLYHEDRALKERNELS_H
+
+#include "ff/Accuracy.h"
+#include "ff/Diagnostics.h"
+#include "ff/Factorial.h"
+#include "ff/Math.h"
+#include "ff/PolyhedralArrays.h"
+#include "ff/PolyhedralComponents.h"
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ff::kernel {
+
+const double eps = 2e-16;
+
+inline constexpr auto ReciprocalFactorialArray = ff_aux::generateReciprocalFactorialArray<171>();
+
+//! Component type of wavevector type V, i.e. double for R3, complex_t for C3.
+template <class V> using scalar_t = std::decay_t<decltype(std::declval<V>().x())>;
+
+//! Returns true if all components of q have zero imaginary part.
+inline bool is_real(const C3& q)
+{
+    return q.x().imag() == 0 && q.y().imag() == 0 && q.z().imag() == 0;
+}
+
+//! Largest M for which contrib uses the precomputed coefficient table.
+//! ff_n_core is called with m < max_contrib_order; higher orders take the slower contrib_pow.
+const int max_contrib_order = 21;
+
+inline constexpr auto ReciprocalFactorialProducts =
+    ff_aux::generateReciprocalFactorialProductTable<max_contrib_order + 1>();
+
+//! Returns x^n, by repeated multiplication.
+
+template <class T> T ipow(T x, int n)
+{
+    T result = 1.;
+    for (int i = 0; i < n; ++i)
+        result *= x;
+    return result;
+}
+
+//! Returns contrib(M, u, v1, v2) for arbitrary M, using std::pow.
+
+//! Fallback for orders beyond the coefficient table of contrib.
+
+template <class T> T contrib_pow(int M, T u, T v1, T v2)
+{
+    const auto& F = ReciprocalFactorialArray;
+    T v = v2 + v1;
+    if (v == 0.) { // only 2l=M contributes
+        if (M & 1) // M is odd
+            return 0.;
+        return F[M] * (std::pow(u, M) / (M + 1.) - std::pow(v1, M));
+    }
+    T result = 0;
+    // the l=0 term, minus (qperp.R)^M, which cancels under the sum over E*contrib()
+    if (v1 == 0.)
+        result = F[M] * std::pow(v2, M);
+    else if (v2 != 0.) {
+        // binomial expansion
+        for (int mm = 1; mm <= M; ++mm)
+            result += F[mm] * F[M - mm] * std::pow(v2, mm) * std::pow(v1, M - mm);
+    }
+    if (u == 0.)
+        return result;
+    for (int l = 1; l <= M / 2; ++l)
+        result += F[M - 2 * l] * F[2 * l + 1] * std::pow(u, 2 * l) * std::pow(v, M - 2 * l);
+    return result;
+}
+
+//! Returns sum_l=0^M/2 u^2l v^(M-2l) / (2l+1)!(M-2l)! - vperp^M/M!
+
+//! @param u    q*E
+//! @param v1   q_perp*r_perp
+//! @param v2   q_pa*R, so that v = v1 + v2 = q*R
+//!
+//! Powers are built up by repeated multiplication, and coefficients are taken from a
+//! precomputed table, so that no pow function is called in the loops.
+//! Orders beyond max_contrib_order are delegated to contrib_pow.
+
+template <class T> T contrib(int M, T u, T v1, T v2)
+{
+    if (M > max_contrib_order)
+        return contrib_pow(M, u, v1, v2);
+    const auto& C = ReciprocalFactorialProducts;
+    T v = v2 + v1;
+    if (v == 0.) { // only 2l=M contributes
+        if (M & 1) // M is odd
+            return 0.;
+        return ReciprocalFactorialArray[M] * (ipow(u, M) / (M + 1.) - ipow(v1, M));
+    }
+    T power[max_contrib_order + 1]; // powers of v1, later of v
+    T result = 0;
+    // the l=0 term, minus (qperp.R)^M, which cancels under the sum over E*contrib()
+    if (v1 == 0.)
+        result = ReciprocalFactorialArray[M] * ipow(v2, M);
+    else if (v2 == 0.) {
+        ; // leave result=0
+    } else {
+        // binomial expansion
+        power[0] = 1.;
+        for (int k = 1; k < M; ++k)
+            power[k] = power[k - 1] * v1;
+        T v2_mm = 1.;
+        for (int mm = 1; mm <= M; ++mm) {
+            v2_mm *= v2;
+            T term = C[mm][M - mm] * v2_mm * power[M - mm];
+            result += term;
+        }
+    }
+    if (u == 0.)
+        return result;
+    power[0] = 1.;
+    for (int k = 1; k <= M - 2; ++k)
+        power[k] = power[k - 1] * v;
+    const T u2 = u * u;
+    T u_2l = 1.;
+    for (int l = 1; l <= M / 2; ++l) {
+        u_2l *= u2;
+        T term = C[M - 2 * l][2 * l + 1] * u_2l * power[M - 2 * l];
+        result += term;
+    }
+    return result;
+}
+
+//! Sets qperp and qpa according to argument q and to the polygon's normal.
+
+template <class Face, class V> void decompose_q(const Face& f, V q, scalar_t<V>& qperp, V& qpa)
+{
+    const R3 normal = f.normal();
+    qperp = normal.dot(q);
+    qpa = q - qperp * normal;
+    // improve numeric accuracy:
+    qpa -= normal.dot(qpa) * normal;
+    if (qpa.mag() < eps * std::abs(qperp))
+        qpa = V(0., 0., 0.);
+}
+
+//! Returns core contribution to f_n
+
+template <class Face, class V>
+scalar_t<V> ff_n_core(const Face& f, int m, V qpa, scalar_t<V> qperp)
+{
+    using T = scalar_t<V>;
+    const V prevec = 2. * f.normal().cross(qpa); // complex conjugation not here but in .dot
+    T result = 0;
+    const T qrperp = qperp * f.rperp();
+    for (size_t i = 0; i < f.nEdges(); ++i) {
+        const R3 E = f.E(i);
+        const T vfac = prevec.dot(E);
+        const T tmp = contrib(m + 1, E.dot(qpa), qrperp, f.R(i).dot(qpa));
+        result += vfac * tmp;
+    }
+    return result;
+}
+
+//! Returns contribution qn*f_n [of order q^(n+1)] from this face to the polyhedral form factor.
+
+template <class Face, class V> scalar_t<V> ff_n(const Face& f, int n, V q)
+{
+    using T = scalar_t<V>;
+    T qn = q.dot(f.normal()); // conj(q)*normal (dot is antilinear in 'this' argument)
+    if (std::abs(qn) < eps * q.mag())
+        return 0.;
+    T qperp;
+    V qpa;
+    decompose_q(f, q, qperp, qpa);
+    double qpa_mag2 = qpa.mag2();
+    if (qpa_mag2 == 0.)
+        return qn * ipow(qperp * f.rperp(), n) * f.area() * ReciprocalFactorialArray[n];
+    if (f.symmetry_S2())
+        return qn * (ff_n_core(f, n, qpa, qperp) + ff_n_core(f, n, -qpa, qperp)) / qpa_mag2;
+    T tmp = ff_n_core(f, n, qpa, qperp);
+    return qn * tmp / qpa_mag2;
+}
+
+//! Generates the edge sums of ff_n_core for consecutive orders, at cost O(edges) per order.
+
+//! Per edge, contrib(M, u, v1, v2) is the coefficient of t^M in exp(vt) sinh(ut)/(ut) - exp(v1 t),
+//! with v = v1 + v2. The differential equation of exp(vt) sinh(ut)/u yields the recurrence
+//!   (M+2)(M+1) d[M+1] = 2v(M+1) d[M] - (v^2-u^2) d[M-1] + (u^2-v2^2+2v1v2/M) v1^(M-1)/(M-1)!
+//! for d[M] = contrib(M), in which the large powers of v1 cancel analytically. Starting from
+//! d[0] = 0 and d[1] = v2, it is at least as accurate as the explicit sums in contrib.
+
+template <class T> class EdgeSeries {
+public:
+    EdgeSeries() : m_edges(workspace()) { m_edges.clear(); }
+    EdgeSeries(const EdgeSeries&) = delete;
+
+    //! Appends the edges of face f, for in-plane wavevector qpa and qrperp = qperp*rperp.
+    template <class Face, class V> void add(const Face& f, V qpa, T qrperp)
+    {
+        if (m_M != 1)
+            throw std::logic_error("EdgeSeries::add called after advance");
+        const V prevec = 2. * f.normal().cross(qpa); // complex conjugation not here but in .dot
+        for (size_t i = 0; i < f.nEdges(); ++i) {
+            const R3 E = f.E(i);
+            const T u = E.dot(qpa);
+            const T v2 = f.R(i).dot(qpa);
+            const T v = qrperp + v2;
+            m_edges.push_back(
+                {prevec.dot(E), 2. * v, v * v - u * u, u * u - v2 * v2, 2. * qrperp * v2, qrperp,
+                 0., v2, 1.});
+        }
+    }
+
+    size_t size() const { return m_edges.size(); }
+    int order() const { return m_M; } //!< current M
+
+    //! Returns the sum of vfac*contrib(order()) over edges [i0, i1).
+    T sum(size_t i0, size_t i1) const
+    {
+        T result = 0;
+        for (size_t i = i0; i < i1; ++i)
+            result += m_edges[i].vfac * m_edges[i].d;
+        return result;
+    }
+    T sum() const { return sum(0, m_edges.size()); }
+
+    //! Increments order().
+    void advance()
+    {
+        const double rM = 1. / m_M;
+        const double rN = 1. / ((m_M + 2.) * (m_M + 1.));
+        for (Edge& e : m_edges) {
+            const T next =
+                (e.two_v * (m_M + 1.) * e.d - e.a * e.d_prev + e.w_prev * (e.b + e.c * rM)) * rN;
+            e.w_prev *= e.v1 * rM;
+            e.d_prev = e.d;
+            e.d = next;
+        }
+        ++m_M;
+    }
+
+private:
+    struct Edge {
+        T vfac;   //!< prevec*E
+        T two_v;  //!< 2v
+        T a;      //!< v^2-u^2
+        T b;      //!< u^2-v2^2
+        T c;      //!< 2 v1 v2
+        T v1;     //!< qperp*rperp
+        T d_prev; //!< contrib(M-1)
+        T d;      //!< contrib(M)
+        T w_prev; //!< v1^(M-1)/(M-1)!
+    };
+    //! Edge storage of the calling thread, reused so that expansions do not allocate once its
+    //! capacity suffices. Hence only one EdgeSeries<T> may exist per thread at a time.
+    static std::vector<Edge>& workspace()
+    {
+        thread_local std::vector<Edge> edges;
+        return edges;
+    }
+    std::vector<Edge>& m_edges;
+    int m_M = 1;
+};
+
+//! Returns sum of n>=1 terms of qpa expansion of 2d form factor
+
+//! If the series does not converge, throws, or sets *failed and returns 0 if failed is given.
+
+template <class Face, class V>
+complex_t expansion(const Face& f, complex_t fac_even, complex_t fac_odd, V qpa, double abslevel,
+                    const Accuracy& acc, bool* failed = nullptr)
+{
+    EdgeSeries<scalar_t<V>> series;
+    series.add(f, qpa, 0.);
+    const double qpa_mag2 = qpa.mag2();
+    complex_t sum = 0;
+    complex_t n_fac = I;
+    int count_return_condition = 0;
+    for (int n = 1; n < acc.n_limit_series; ++n) {
+        series.advance(); // now at the order of ff_n_core(f, n, qpa, 0)
+        complex_t term = n_fac * (n & 1 ? fac_odd : fac_even) * series.sum() / qpa_mag2;
+        sum += term;
+        if (std::abs(term) <= acc.tolerance * std::abs(sum)
+            || std::abs(sum) < acc.tolerance * abslevel)
+            ++count_return_condition;
+        else
+            count_return_condition = 0;
+        if (count_return_condition > 2) {
+            if (Diagnostics* diag = Diagnostics::active())
+                diag->countExpansion(n);
+            return sum; // regular exit
+        }
+        n_fac = mul_I(n_fac);
+    }
+    if (failed) {
+        *failed = true;
+        return 0;
+    }
+    throw std::runtime_error("Numeric error in polyhedral face: series f(q_pa) not converged");
+}
+
+//! Returns core contribution to analytic 2d form factor.
+
+//! For real q, all factors except exp_I(qR) are real, so that only the final product
+//! involves complex arithmetic.
+
+template <class Face, class V> complex_t edge_sum_ff(const Face& f, V q, V qpa, bool sym_Ci)
+{
+    using T = scalar_t<V>;
+    const bool sym_S2 = f.symmetry_S2();
+    const size_t NE = f.nEdges();
+    V prevec = f.normal().cross(qpa); // complex conjugation will take place in .dot
+    complex_t sum = 0;
+    T vfacsum = 0;
+    for (size_t i = 0; i < NE; ++i) {
+        const R3 E = f.E(i);
+        const R3 R = f.R(i);
+        T qE = E.dot(qpa);
+        T qR = R.dot(qpa);
+        complex_t Rfac = sym_S2 ? ff_aux::sin(qR)
+                                : (sym_Ci ? ff_aux::cos(R.dot(q)) : ff_aux::exp_I(qR));
+        T vfac;
+        if (sym_S2 || i < NE - 1) {
+            vfac = prevec.dot(E);
+            vfacsum += vfac;
+        } else {
+            vfac = -vfacsum; // to improve numeric accuracy: qcE_J = - sum_{j=0}^{J-1} qcE_j
+        }
+        complex_t term = vfac * ff_aux::sinc(qE) * Rfac;
+        sum += term;
+    }
+    return sum;
+}
+
+//! Computes the edge factors g[s] = sinc(q*E) * exp(i*q*R), resp. sinc(q*E) * cos(q*R) under
+//! symmetry Ci, for all shared edges s of a polyhedron.
+
+//! With the full wavevector q in place of its in-plane component q_pa, the factors are the
+//! same for both faces that border an edge; the phase exp(i*q_perp*r_perp) of the face is
+//! absorbed into exp(i*q*R).
+
+template <class V> void shared_edge_factors(const PolyhedralArrays& a, V q, bool sym_Ci,
+                                            complex_t* g)
+{
+    for (size_t s = 0; s < a.nSharedEdges(); ++s) {
+        const R3 E(a.sEx[s], a.sEy[s], a.sEz[s]);
+        const R3 R(a.sRx[s], a.sRy[s], a.sRz[s]);
+        const auto qR = R.dot(q);
+        g[s] = ff_aux::sinc(E.dot(q)) * (sym_Ci ? ff_aux::cos(qR) : ff_aux::exp_I(qR));
+    }
+}
+
+//! Same as edge_sum_ff for a face without symmetry S2, but with precomputed edge factors.
+
+template <class V> complex_t edge_sum_shared(const PolyhedralArrays::Face& f, V qpa,
+                                             const complex_t* g)
+{
+    using T = scalar_t<V>;
+    const size_t NE = f.nEdges();
+    V prevec = f.normal().cross(qpa); // complex conjugation will take place in .dot
+    complex_t sum = 0;
+    T vfacsum = 0;
+    for (size_t i = 0; i < NE - 1; ++i) {
+        T vfac = prevec.dot(f.E(i));
+        vfacsum += vfac;
+        sum += vfac * g[f.shared(i)];
+    }
+    return sum - vfacsum * g[f.shared(NE - 1)]; // to improve numeric accuracy
+}
+
+//! Returns the contribution ff(q) of this face to the polyhedral form factor.
+
+//! If g is given, it must hold the shared edge factors of the polyhedron at q, and f must be a
+//! face of the same polyhedron. For failed, see expansion.
+
+template <class Face, class V>
+complex_t ff(const Face& f, V q, bool sym_Ci, const Accuracy& acc, const complex_t* g = nullptr,
+             bool* failed = nullptr)
+{
+    using T = scalar_t<V>;
+    const bool sym_S2 = f.symmetry_S2();
+    T qperp;
+    V qpa;
+    decompose_q(f, q, qperp, qpa);
+    double qpa_red = f.radius2d() * qpa.mag();
+    T qr_perp = qperp * f.rperp();
+    complex_t ff0 = (sym_Ci ? 2. * I * ff_aux::sin(qr_perp) : ff_aux::exp_I(qr_perp)) * f.area();
+    if (qpa_red == 0)
+        return ff0;
+    if (qpa_red < acc.qpa_limit_series && !sym_S2) {
+        // summation of power series
+        complex_t fac_even;
+        complex_t fac_odd;
+        if (sym_Ci) {
+            T s, c;
+            ff_aux::sincos(qr_perp, s, c);
+            fac_even = 2. * mul_I(s);
+            fac_odd = 2. * c;
+        } else {
+            fac_even = ff_aux::exp_I(qr_perp);
+            fac_odd = fac_even;
+        }
+        return ff0 + expansion(f, fac_even, fac_odd, qpa, std::abs(ff0), acc, failed);
+    }
+    // direct evaluation of analytic formula
+    if constexpr (std::is_same_v<Face, PolyhedralArrays::Face>)
+        if (g && !sym_S2)
+            return (sym_Ci ? 4. : 2.) * edge_sum_shared(f, qpa, g) / mul_I(qpa.mag2());
+    complex_t prefac;
+    if (sym_S2)
+        prefac = sym_Ci ? -8. * ff_aux::sin(qr_perp) : 4. * mul_I(ff_aux::exp_I(qr_perp));
+    else
+        prefac = sym_Ci ? 4. : 2. * ff_aux::exp_I(qr_perp);
+    return prefac * edge_sum_ff(f, q, qpa, sym_Ci) / mul_I(qpa.mag2());
+}
+
+//! Two-dimensional form factor, for use in prism, from power series.
+
+template <class Face, class V>
+complex_t ff_2D_expanded(const Face& f, V qpa, const Accuracy& acc, bool* failed = nullptr)
+{
+    return f.area() + expansion(f, 1., 1., qpa, std::abs(f.area()), acc, failed);
+}
+
+//! Two-dimensional form factor, for use in prism, from sum over edge form factors.
+
+template <class Face, class V> complex_t ff_2D_direct(const Face& f, V qpa)
+{
+    return (f.symmetry_S2() ? 4. : 2. / I) * edge_sum_ff(f, qpa, qpa, false) / qpa.mag2();
+}
+
+//! Returns the two-dimensional form factor of a face, for use in a prism.
+
+//! For failed, see expansion.
+
+template <class Face, class V>
+complex_t ff_2D(const Face& f, V qpa, const Accuracy& acc, bool* failed = nullptr)
+{
+    if (std::abs(qpa.dot(f.normal())) > eps * qpa.mag())
+        throw std::runtime_error(
+            "Numeric error in polyhedral formfactor: ff_2D called with perpendicular q component");
+    double qpa_red = f.radius2d() * qpa.mag();
+    if (qpa_red == 0)
+        return f.area();
+    if (qpa_red < acc.qpa_limit_series && !f.symmetry_S2())
+        return ff_2D_expanded(f, qpa, acc, failed);
+    return ff_2D_direct(f, qpa);
+}
+
+} // namespace ff::kernel
+
+#endif // FORMFACTOR_FF_POLYHEDRALKERNELS_H
@@ -0,0 +1,138 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralRay.cpp
+//! @brief     Implements ray-scan kernel for the analytic branch of the polyhedral form factor.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! Same algorithm as kernel::ff, with real q = t*u. Along the ray, qperp, qpa, q*E, q*R and
+//! the edge prefactors are all proportional to t. The trigonometric factors are therefore
+//! obtained from phasors exp(i*t*x), which are advanced from step to step by multiplication
+//! with exp(i*dt*x), and recomputed every anchor_interval steps.
+
+#include "ff/PolyhedralRay.h"
+#include "ff/PolyhedralKernels.h"
+#include <cmath>
+
+void ff::ray::analytic_sum(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc,
+                           const R3& u, double t0, double dt, size_t n, const char* analytic,
+                           complex_t* sum, Diagnostics* diag)
+{
+    const size_t NF = a.nFaces();
+    const size_t NE = a.nEdges();
+
+    // per face, in units of t: qn = q*normal = qperp, |qpa|
+    std::vector<double> un(NF), upa_mag(NF);
+    std::vector<char> relevant(NF), flat(NF);
+    // per edge, in units of t: q*E, phase of Rfac, vfac
+    std::vector<double> ue(NE), uw(NE), uv(NE);
+
+    for (size_t k = 0; k < NF; ++k) {
+        const PolyhedralArrays::Face f = a.face(k);
+        const bool sym_S2 = f.symmetry_S2();
+        const R3 normal = f.normal();
+        double uperp;
+        R3 upa;
+        kernel::decompose_q(f, u, uperp, upa);
+        un[k] = uperp;
+        upa_mag[k] = upa.mag();
+        relevant[k] = !(std::abs(uperp) < kernel::eps * u.mag());
+        flat[k] = upa_mag[k] == 0;
+        const R3 prevec = normal.cross(upa);
+        double vfacsum = 0;
+        const size_t NEk = f.nEdges();
+        for (size_t i = 0; i < NEk; ++i) {
+            const size_t ii = a.edgeBegin[k] + i;
+            const R3 E = f.E(i);
+            const R3 R = f.R(i);
+            ue[ii] = E.dot(upa);
+            uw[ii] = (sym_Ci && !sym_S2) ? R.dot(u) : R.dot(upa);
+            if (sym_S2 || i < NEk - 1) {
+                uv[ii] = prevec.dot(E);
+                vfacsum += uv[ii];
+            } else {
+                uv[ii] = -vfacsum;
+            }
+        }
+    }
+
+    // phasors exp(i*t*x) and their increments exp(i*dt*x)
+    std::vector<complex_t> P(NE), Q(NE), F(NF);
+    std::vector<complex_t> dP(NE), dQ(NE), dF(NF);
+    for (size_t ii = 0; ii < NE; ++ii) {
+        dP[ii] = ff_aux::exp_I(dt * ue[ii]);
+        dQ[ii] = ff_aux::exp_I(dt * uw[ii]);
+    }
+    for (size_t k = 0; k < NF; ++k)
+        dF[k] = ff_aux::exp_I(dt * un[k] * a.rperp[k]);
+
+    for (size_t j = 0; j < n; ++j) {
+        const double t = t0 + j * dt;
+        if (j % anchor_interval == 0) {
+            for (size_t ii = 0; ii < NE; ++ii) {
+                P[ii] = ff_aux::exp_I(t * ue[ii]);
+                Q[ii] = ff_aux::exp_I(t * uw[ii]);
+            }
+            for (size_t k = 0; k < NF; ++k)
+                F[k] = ff_aux::exp_I(t * un[k] * a.rperp[k]);
+        } else {
+            for (size_t ii = 0; ii < NE; ++ii) {
+                P[ii] *= dP[ii];
+                Q[ii] *= dQ[ii];
+            }
+            for (size_t k = 0; k < NF; ++k)
+                F[k] *= dF[k];
+        }
+        if (!analytic[j])
+            continue;
+
+        const R3 q = t * u;
+        const size_t expansions = diag ? diag->expansions : 0;
+        complex_t s = 0;
+        for (size_t k = 0; k < NF; ++k) {
+            if (!relevant[k])
+                continue;
+            const PolyhedralArrays::Face f = a.face(k);
+            const bool sym_S2 = f.symmetry_S2();
+            const double qn = t * un[k];
+            const double qpa_red = f.radius2d() * std::abs(t) * upa_mag[k];
+            if (flat[k]) {
+                const complex_t ff0 = (sym_Ci ? 2. * I * F[k].imag() : F[k]) * f.area();
+                s += qn * ff0;
+                continue;
+            }
+            if (qpa_red < acc.qpa_limit_series && !sym_S2) {
+                s += qn * kernel::ff(f, q, sym_Ci, acc);
+                continue;
+            }
+            // edge sum, cf. kernel::edge_sum_ff, with vfac*sinc(qE) = (uv/ue)*sin(t*ue)
+            complex_t edge_sum = 0;
+            for (size_t ii = a.edgeBegin[k]; ii < a.edgeBegin[k + 1]; ++ii) {
+                const double vsinc = ue[ii] == 0 ? t * uv[ii] : uv[ii] / ue[ii] * P[ii].imag();
+                if (sym_S2)
+                    edge_sum += vsinc * Q[ii].imag();
+                else if (sym_Ci)
+                    edge_sum += vsinc * Q[ii].real();
+                else
+                    edge_sum += vsinc * Q[ii];
+            }
+            complex_t prefac;
+            if (sym_S2)
+                prefac = sym_Ci ? -8. * F[k].imag() : 4. * mul_I(F[k]);
+            else
+                prefac = sym_Ci ? 4. : 2. * F[k];
+            const double qpa_mag = t * upa_mag[k];
+            s += qn * prefac * edge_sum / mul_I(qpa_mag * qpa_mag);
+        }
+        sum[j] = s;
+        if (diag)
+            diag->countAnalytic(diag->expansions - expansions);
+    }
+}
@@ -0,0 +1,39 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralRay.h
+//! @brief     Declares ray-scan kernel for the analytic branch of the polyhedral form factor.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! For internal use in Polyhedron.cpp.
+
+#ifndef FORMFACTOR_FF_POLYHEDRALRAY_H
+#define FORMFACTOR_FF_POLYHEDRALRAY_H
+
+#include "ff/Diagnostics.h"
+#include "ff/PolyhedralArrays.h"
+
+namespace ff::ray {
+
+//! Number of steps after which the phasors are recomputed from scratch, to bound the drift.
+const size_t anchor_interval = 32;
+
+//! Computes the analytic sum over all faces, sum_k qn_k ff_k(q), for q = (t0+j*dt)*u.
+
+//! Only entries j < n with analytic[j] true are written. The result is yet to be divided
+//! by i*q^2. Faces that need the series expansion of their 2d form factor get their
+//! contribution from the scalar kernel. If diag is not null, the evaluations are recorded there.
+void analytic_sum(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc, const R3& u,
+                  double t0, double dt, size_t n, const char* analytic, complex_t* sum,
+                  Diagnostics* diag);
+
+} // namespace ff::ray
+
+#endif // FORMFACTOR_FF_POLYHEDRALRAY_H
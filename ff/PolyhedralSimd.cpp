@@ -0,0 +1,292 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralSimd.cpp
+//! @brief     Implements lockstep kernel for the analytic branch of the polyhedral form factor.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! Same algorithm as kernel::ff, with real q, and with lanes() wavevectors in lockstep.
+//! All lanes run through the same faces and edges, so that per-edge and per-face data are
+//! broadcast, and all arithmetic, including sine and cosine, is vectorized across lanes.
+//! The kernel is templated on the pack type: double, or float with twice as many lanes.
+//! In either case, face contributions are accumulated in double precision.
+//! Edge factors of faces without symmetry S2 are computed once per shared edge, and used
+//! for both faces that border the edge.
+
+#include "ff/PolyhedralSimd.h"
+#include "ff/PolyhedralKernels.h"
+#include "ff/Simd.h"
+#include <algorithm>
+#include <vector>
+
+using ff::simd::Md;
+using ff::simd::Mf;
+using ff::simd::Vd;
+using ff::simd::Vf;
+
+namespace {
+
+//! Number of lanes, and conversion from double, for packs of double and float.
+
+template <class V> struct Lanes;
+
+template <> struct Lanes<Vd> {
+    static constexpr int n = ff::simd::width;
+    static Vd load(const double* p) { return Vd::load(p); }
+};
+
+template <> struct Lanes<Vf> {
+    static constexpr int n = ff::simd::width_f;
+    static Vf load(const double* p)
+    {
+        float f[n];
+        for (int l = 0; l < n; ++l)
+            f[l] = static_cast<float>(p[l]);
+        return Vf::load(f);
+    }
+};
+
+//! Sum of face contributions, accumulated in double precision.
+
+template <class V> struct Accumulator;
+
+template <> struct Accumulator<Vd> {
+    Vd re{0.};
+    Vd im{0.};
+    void add(Vd r, Vd i)
+    {
+        re += r;
+        im += i;
+    }
+    void store(double* r, double* i) const
+    {
+        re.store(r);
+        im.store(i);
+    }
+};
+
+template <> struct Accumulator<Vf> {
+    Vd re[2] = {Vd(0.), Vd(0.)};
+    Vd im[2] = {Vd(0.), Vd(0.)};
+    void add(Vf r, Vf i)
+    {
+        Vd lo, hi;
+        widen(r, lo, hi);
+        re[0] += lo;
+        re[1] += hi;
+        widen(i, lo, hi);
+        im[0] += lo;
+        im[1] += hi;
+    }
+    void store(double* r, double* i) const
+    {
+        for (int h = 0; h < 2; ++h) {
+            re[h].store(r + h * ff::simd::width);
+            im[h].store(i + h * ff::simd::width);
+        }
+    }
+};
+
+//! Lockstep kernel for pack type V with mask type M and scalar type T.
+
+//! Lanes in which a face has q_pa*radius2d below qpa_limit (or below qpa_limit_S2 for faces
+//! with symmetry S2) get this face's contribution from the scalar kernel in double precision.
+//! Padding lanes, l >= n, skip the scalar kernel.
+
+template <class T, class V, class M>
+void lockstep(const ff::PolyhedralArrays& a, bool sym_Ci, const ff::Accuracy& acc,
+              double qpa_limit, double qpa_limit_S2, size_t n, const double* qx_,
+              const double* qy_, const double* qz_, complex_t* sum, bool* failed,
+              ff::Diagnostics* diag)
+{
+    namespace kernel = ff::kernel;
+    constexpr int N = Lanes<V>::n;
+    const V qx = Lanes<V>::load(qx_);
+    const V qy = Lanes<V>::load(qy_);
+    const V qz = Lanes<V>::load(qz_);
+    const V qmag = sqrt(qx * qx + qy * qy + qz * qz);
+    const V zero(T(0));
+    const V eps(T(kernel::eps));
+
+    Accumulator<V> acc_sum;
+    complex_t scalar_sum[N] = {};
+    size_t expanded[N] = {};
+    const int used = n < N ? (1 << n) - 1 : (1 << N) - 1;
+
+    // shared edge factors sinc(q*E) * exp(i*q*R), resp. sinc(q*E) * cos(q*R) under symmetry Ci
+    thread_local std::vector<V> g_re, g_im;
+    g_re.resize(a.nSharedEdges());
+    g_im.resize(a.nSharedEdges());
+    for (size_t s = 0; s < a.nSharedEdges(); ++s) {
+        const V qE = V(T(a.sEx[s])) * qx + V(T(a.sEy[s])) * qy + V(T(a.sEz[s])) * qz;
+        V sE, cE;
+        sincos(qE, sE, cE);
+        const V f = select(qE == zero, V(T(1)), sE / qE);
+        V sR, cR;
+        sincos(V(T(a.sRx[s])) * qx + V(T(a.sRy[s])) * qy + V(T(a.sRz[s])) * qz, sR, cR);
+        g_re[s] = f * cR;
+        g_im[s] = sym_Ci ? zero : f * sR;
+    }
+
+    for (size_t k = 0; k < a.nFaces(); ++k) {
+        const bool sym_S2 = a.symS2[k];
+        const V nx(T(a.nx[k]));
+        const V ny(T(a.ny[k]));
+        const V nz(T(a.nz[k]));
+
+        // qn = q*normal, which for real q coincides with qperp
+        const V qn = nx * qx + ny * qy + nz * qz;
+        const M relevant = !(abs(qn) < eps * qmag);
+        if (!any(relevant))
+            continue;
+
+        // decompose q
+        V px = qx - qn * nx;
+        V py = qy - qn * ny;
+        V pz = qz - qn * nz;
+        const V d = nx * px + ny * py + nz * pz; // improve numeric accuracy
+        px -= d * nx;
+        py -= d * ny;
+        pz -= d * nz;
+        V qpa_mag2 = px * px + py * py + pz * pz;
+        const M qpa_zero = sqrt(qpa_mag2) < eps * abs(qn);
+        px = select(qpa_zero, zero, px);
+        py = select(qpa_zero, zero, py);
+        pz = select(qpa_zero, zero, pz);
+        qpa_mag2 = select(qpa_zero, zero, qpa_mag2);
+        const V qpa_red = V(T(a.radius2d[k])) * sqrt(qpa_mag2);
+        const M flat = qpa_red == zero;
+        const M series = (qpa_red < V(T(sym_S2 ? qpa_limit_S2 : qpa_limit))) & !flat;
+
+        V s_perp, c_perp;
+        sincos(qn * V(T(a.rperp[k])), s_perp, c_perp);
+        const V area(T(a.area[k]));
+
+        V ff_re, ff_im;
+        if (any(relevant & !flat & !series)) {
+            // direct evaluation of analytic formula
+            const V pvx = ny * pz - nz * py; // normal x qpa
+            const V pvy = nz * px - nx * pz;
+            const V pvz = nx * py - ny * px;
+            V es_re = zero;
+            V es_im = zero;
+            V vfacsum = zero;
+            const size_t jbeg = a.edgeBegin[k];
+            const size_t jend = a.edgeBegin[k + 1];
+            for (size_t j = jbeg; j < jend; ++j) {
+                const V Ex(T(a.Ex[j]));
+                const V Ey(T(a.Ey[j]));
+                const V Ez(T(a.Ez[j]));
+                V vfac;
+                if (sym_S2 || j < jend - 1) {
+                    vfac = pvx * Ex + pvy * Ey + pvz * Ez;
+                    vfacsum += vfac;
+                } else {
+                    vfac = -vfacsum; // to improve numeric accuracy: qcE_J = - sum_{j=0}^{J-1} qcE_j
+                }
+                if (!sym_S2) {
+                    const size_t s = a.sharedEdge[j];
+                    es_re += vfac * g_re[s];
+                    es_im += vfac * g_im[s];
+                    continue;
+                }
+                const V qE = Ex * px + Ey * py + Ez * pz;
+                V sE, cE;
+                sincos(qE, sE, cE);
+                const V f = vfac * select(qE == zero, V(T(1)), sE / qE);
+                V sR, cR;
+                sincos(V(T(a.Rx[j])) * px + V(T(a.Ry[j])) * py + V(T(a.Rz[j])) * pz, sR, cR);
+                es_re += f * sR;
+            }
+            V pre_re, pre_im;
+            if (sym_S2) {
+                pre_re = sym_Ci ? V(T(-8)) * s_perp : V(T(-4)) * s_perp;
+                pre_im = sym_Ci ? zero : V(T(4)) * c_perp;
+            } else {
+                // the face phase exp(i*qperp*rperp) is included in the shared edge factors
+                pre_re = V(T(sym_Ci ? 4 : 2));
+                pre_im = zero;
+            }
+            // divide prefac * edge sum by i*qpa^2
+            ff_re = (pre_re * es_im + pre_im * es_re) / qpa_mag2;
+            ff_im = -(pre_re * es_re - pre_im * es_im) / qpa_mag2;
+        } else {
+            ff_re = zero;
+            ff_im = zero;
+        }
+
+        // faces perpendicular to q: ff0 = (Ci ? 2i*sin(qr_perp) : exp_I(qr_perp)) * area
+        ff_re = select(flat, sym_Ci ? zero : c_perp * area, ff_re);
+        ff_im = select(flat, sym_Ci ? V(T(2)) * s_perp * area : s_perp * area, ff_im);
+
+        const M vectorized = relevant & !series;
+        acc_sum.add(select(vectorized, qn * ff_re, zero), select(vectorized, qn * ff_im, zero));
+
+        const int fallback = (relevant & series).bits() & used;
+        if (!fallback)
+            continue;
+        for (int l = 0; l < N; ++l) {
+            if (!(fallback >> l & 1))
+                continue;
+            const R3 q(qx_[l], qy_[l], qz_[l]);
+            const ff::PolyhedralArrays::Face Gk = a.face(k);
+            bool* const failed_l = failed ? failed + l : nullptr;
+            const size_t expansions = diag ? diag->expansions : 0;
+            scalar_sum[l] +=
+                q.dot(Gk.normal()) * kernel::ff(Gk, q, sym_Ci, acc, nullptr, failed_l);
+            if (diag)
+                expanded[l] += diag->expansions - expansions;
+        }
+    }
+
+    double re[N], im[N];
+    acc_sum.store(re, im);
+    for (int l = 0; l < N; ++l)
+        sum[l] = complex_t(re[l], im[l]) + scalar_sum[l];
+    if (diag)
+        for (size_t l = 0; l < n; ++l)
+            diag->countAnalytic(expanded[l]);
+}
+
+} // namespace
+
+bool ff::simd::vectorized()
+{
+    return is_vectorized;
+}
+
+int ff::simd::lanes()
+{
+    return width;
+}
+
+int ff::simd::lanes_single()
+{
+    return width_f;
+}
+
+void ff::simd::analytic_sum(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc,
+                            size_t n, const double* qx, const double* qy, const double* qz,
+                            complex_t* sum, bool* failed, Diagnostics* diag)
+{
+    // faces with symmetry S2 are never expanded
+    lockstep<double, Vd, Md>(a, sym_Ci, acc, acc.qpa_limit_series, 0., n, qx, qy, qz, sum,
+                             failed, diag);
+}
+
+void ff::simd::analytic_sum_single(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc,
+                                   size_t n, const double* qx, const double* qy,
+                                   const double* qz, complex_t* sum, bool* failed,
+                                   Diagnostics* diag)
+{
+    const double qpa_limit = std::max(acc.qpa_limit_series, acc.qpa_limit_single);
+    lockstep<float, Vf, Mf>(a, sym_Ci, acc, qpa_limit, acc.qpa_limit_single, n, qx, qy, qz, sum,
+                            failed, diag);
+}
@@ -0,0 +1,56 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/PolyhedralSimd.h
+//! @brief     Declares lockstep kernel for the analytic branch of the polyhedral form factor.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! For internal use in Polyhedron.cpp.
+
+#ifndef FORMFACTOR_FF_POLYHEDRALSIMD_H
+#define FORMFACTOR_FF_POLYHEDRALSIMD_H
+
+#include "ff/Diagnostics.h"
+#include "ff/PolyhedralArrays.h"
+
+namespace ff::simd {
+
+//! Returns true if the library is compiled for an instruction set with SIMD packs,
+//! i.e. if the lockstep kernel is faster than the scalar one.
+bool vectorized();
+
+//! Number of wavevectors processed in lockstep.
+int lanes();
+
+//! Computes the analytic sum over all faces, sum_k qn_k ff_k(q), for lanes() real wavevectors.
+
+//! Arrays qx, qy, qz, and sum must have lanes() entries, of which the first n are used;
+//! the others are padding, and their sums are meaningless. The result is yet to be divided
+//! by i*q^2. Lanes for which a face needs the series expansion of its 2d form factor
+//! get this face's contribution from the scalar kernel. If such an expansion does not
+//! converge, failed[l] is set, or an exception is thrown if failed is null. If diag is not
+//! null, the n evaluations are recorded there.
+void analytic_sum(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc, size_t n,
+                  const double* qx, const double* qy, const double* qz, complex_t* sum,
+                  bool* failed, Diagnostics* diag);
+
+//! Number of wavevectors processed in lockstep in single precision.
+int lanes_single();
+
+//! Same as analytic_sum, for lanes_single() wavevectors, with phases and edge sums computed
+//! in single precision. Faces with q_pa*radius2d below acc.qpa_limit_single get their
+//! contribution from the scalar kernel in double precision.
+void analytic_sum_single(const PolyhedralArrays& a, bool sym_Ci, const Accuracy& acc, size_t n,
+                         const double* qx, const double* qy, const double* qz, complex_t* sum,
+                         bool* failed, Diagnostics* diag);
+
+} // namespace ff::simd
+
+#endif // FORMFACTOR_FF_POLYHEDRALSIMD_H
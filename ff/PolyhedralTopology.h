@@ -3,7 +3,7 @@
 //  libformfactor: efficient and accurate computation of scattering form factors
 //
 //! @file      ff/PolyhedralTopology.h
-//! @brief     Defines classes PolygonalTopology, PolyhedralTopology
+//! @brief     Defines classes PolygonalTopology, PolyhedralTopology, StaticTopology
 //!
 //! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
 //! @license   GNU General Public License v3 or higher (see LICENSE)
@@ -15,6 +15,9 @@
 #ifndef FORMFACTOR_FF_POLYHEDRALTOPOLOGY_H
 #define FORMFACTOR_FF_POLYHEDRALTOPOLOGY_H
 
+#include <array>
+#include <cstddef>
+#include <initializer_list>
 #include <vector>
 
 namespace ff {
@@ -33,6 +36,90 @@ public:
     bool symmetry_Ci;
 };
 
+//! One face of a StaticTopology: up to MaxNV vertex indices, stored inline.
+
+template <size_t MaxNV> struct StaticPolygon {
+    constexpr StaticPolygon() : vertexIndices{}, nVertices(0), symmetry_S2(false) {}
+    constexpr StaticPolygon(std::initializer_list<int> indices, bool symmetry_S2_)
+        : vertexIndices{}, nVertices(indices.size()), symmetry_S2(symmetry_S2_)
+    {
+        size_t i = 0;
+        for (int v : indices)
+            if (i < MaxNV)
+                vertexIndices[i++] = v;
+    }
+    std::array<int, MaxNV> vertexIndices;
+    size_t nVertices;
+    bool symmetry_S2;
+};
+
+//! Topology of a built-in shape with NF faces of at most MaxNV vertices, as compile-time
+//! constant. Written with the same initializer syntax as PolyhedralTopology, and checked
+//! by static_assert(isValid()).
+
+template <size_t NF, size_t MaxNV> class StaticTopology {
+public:
+    constexpr StaticTopology(std::initializer_list<StaticPolygon<MaxNV>> faces_, bool symmetry_Ci_)
+        : faces{}, nFaces(faces_.size()), symmetry_Ci(symmetry_Ci_)
+    {
+        size_t k = 0;
+        for (const StaticPolygon<MaxNV>& f : faces_)
+            if (k < NF)
+                faces[k++] = f;
+    }
+
+    //! Returns true if the face list is complete, if every face has at least three and at most
+    //! MaxNV vertices, if faces with symmetry S2 have an even number of vertices, if symmetry
+    //! Ci comes with an even number of faces, and if the faces form a closed, consistently
+    //! oriented surface: each directed edge occurs once, and so does its reverse.
+    constexpr bool isValid() const
+    {
+        if (nFaces != NF || (symmetry_Ci && NF % 2))
+            return false;
+        for (size_t k = 0; k < NF; ++k) {
+            const size_t NV = faces[k].nVertices;
+            if (NV < 3 || NV > MaxNV || (faces[k].symmetry_S2 && NV % 2))
+                return false;
+            for (size_t i = 0; i < NV; ++i) {
+                const int a = faces[k].vertexIndices[i];
+                const int b = faces[k].vertexIndices[(i + 1) % NV];
+                if (a < 0 || a == b || countEdges(a, b) != 1 || countEdges(b, a) != 1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    //! Returns the equivalent run-time topology.
+    PolyhedralTopology toTopology() const
+    {
+        PolyhedralTopology result{{}, symmetry_Ci};
+        result.faces.reserve(NF);
+        for (const StaticPolygon<MaxNV>& f : faces)
+            result.faces.push_back(
+                {{f.vertexIndices.begin(), f.vertexIndices.begin() + f.nVertices}, f.symmetry_S2});
+        return result;
+    }
+
+    std::array<StaticPolygon<MaxNV>, NF> faces;
+    size_t nFaces;
+    bool symmetry_Ci;
+
+private:
+    //! Returns the number of occurrences of directed edge a->b in all faces.
+    constexpr size_t countEdges(int a, int b) const
+    {
+        size_t result = 0;
+        for (size_t k = 0; k < NF; ++k) {
+            const size_t NV = faces[k].nVertices;
+            for (size_t i = 0; i < NV; ++i)
+                if (faces[k].vertexIndices[i] == a && faces[k].vertexIndices[(i + 1) % NV] == b)
+                    ++result;
+        }
+        return result;
+    }
+};
+
 } // namespace ff
 
 #endif // FORMFACTOR_FF_POLYHEDRALTOPOLOGY_H
@@ -17,40 +17,206 @@
 //! "Numerically stable form factor of any polygon and polyhedron"
 
 #include "ff/Polyhedron.h"
+#include "ff/PolyhedralKernels.h"
+#include "ff/PolyhedralRay.h"
+#include "ff/PolyhedralSimd.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <stdexcept>
 
-#ifdef ALGORITHM_DIAGNOSTIC_LEVEL2
-#include <boost/format.hpp>
-#endif
-
 namespace {
 
 const double eps = 2e-16;
-const double q_limit_series = 1e-2;
-const int n_limit_series = 20;
 
-} // namespace
+//! Number of complex wavevectors whose shared edge factors are held at once in a batch.
+const size_t complexBlock = 64;
 
+//! Returns the number of monomials x^a y^b z^c of degree a+b+c < n.
+constexpr size_t nMonomials(int n)
+{
+    return n * (n + 1) * (n + 2) / 6;
+}
 
-ff::Polyhedron::Polyhedron(const PolyhedralTopology& topology, const std::vector<R3>& vertices)
-    : m_sym_Ci(topology.symmetry_Ci)
+//! Returns the index of x^a y^b z^c among the monomials of degree n=a+b+c, with m=b+c.
+constexpr size_t monomialIndex(int m, int c)
+{
+    return m * (m + 1) / 2 + c;
+}
+
+//! Adds (L*q) P(q) to S(q), where P and S are homogeneous polynomials of degree n and n+1.
+void addTimesLinear(const double* P, int n, const R3& L, double* S)
+{
+    for (int m = 0; m <= n; ++m)
+        for (int c = 0; c <= m; ++c) {
+            const double p = P[monomialIndex(m, c)];
+            S[monomialIndex(m, c)] += L.x() * p;
+            S[monomialIndex(m + 1, c)] += L.y() * p;
+            S[monomialIndex(m + 1, c + 1)] += L.z() * p;
+        }
+}
+
+//! Returns 1/z, by multiplication instead of the slower library division.
+complex_t inverse(complex_t z)
+{
+    return std::conj(z) / std::norm(z);
+}
+
+//! Computes the divided differences exp[0,z] = (e^z-1)/z and exp[0,0,z] = (e^z-1-z)/z^2,
+//! given ez = e^z and zinv = 1/z.
+void expDividedDifferences(complex_t z, complex_t zinv, complex_t ez, complex_t& d1,
+                           complex_t& d2)
+{
+    const double r2 = std::norm(z);
+    if (r2 >= 1) {
+        d1 = (ez - 1.) * zinv;
+        d2 = (d1 - 1.) * zinv;
+        return;
+    }
+    // Horner scheme for sum_j<N z^j/(j+2)!, with N such that |z|^N/(N+2)! is negligible
+    const double r = std::sqrt(r2);
+    int N = 1;
+    for (double bound = r / 6; N < 20 && bound > .1 * eps; bound *= r / (N + 2))
+        ++N;
+    d2 = ff::kernel::ReciprocalFactorialArray[N + 1];
+    for (int j = N - 2; j >= 0; --j)
+        d2 = d2 * z + ff::kernel::ReciprocalFactorialArray[j + 2];
+    d1 = 1. + z * d2;
+}
+
+//! Returns the divided difference exp[0,0,x,y], for |x|, |y| <= 1.
+
+//! By the Hermite-Genocchi formula, exp[0,0,x,y] = int lambda_0 e^(lambda_1 x + lambda_2 y)
+//! over the unit simplex, and equals sum_k h_k(x,y)/(k+3)!, where the complete homogeneous
+//! polynomial h_k(x,y) = sum_j x^j y^(k-j) = y h_k-1 + x^k is bounded by (k+1) r^k. For
+//! |x|, |y| <= 1, the result has modulus above 0.03.
+
+complex_t expDividedDifferenceSeries(complex_t x, complex_t y)
+{
+    const double r = std::sqrt(std::max(std::norm(x), std::norm(y)));
+    complex_t sum = 1. / 6;
+    complex_t h = 1;
+    complex_t xk = 1;
+    double rf = 1. / 6; // 1/(k+3)!
+    double bound = 1;   // (k+1) r^k
+    for (int k = 1; k < 30; ++k) {
+        xk *= x;
+        h = y * h + xk;
+        rf /= k + 3;
+        bound *= r * (k + 1.) / k;
+        sum += h * rf;
+        if (bound * rf < .03 * eps)
+            break;
+    }
+    return sum;
+}
+
+double polyhedralDiameter(const std::vector<R3>& vertices)
 {
     double diameter = 0;
     for (size_t j = 0; j < vertices.size(); ++j)
         for (size_t jj = j + 1; jj < vertices.size(); ++jj)
             diameter = std::max(diameter, (vertices[j] - vertices[jj]).mag());
+    return diameter;
+}
+
+//! Returns the point group that is known from the topology alone.
+
+const ff::PointGroup& topologyGroup(bool sym_Ci)
+{
+    static const ff::PointGroup trivial(false);
+    static const ff::PointGroup inversion(true);
+    return sym_Ci ? inversion : trivial;
+}
+
+} // namespace
+
+
+ff::Polyhedron::Polyhedron(const PolyhedralTopology& topology, const std::vector<R3>& vertices)
+    : Polyhedron(std::nothrow, topology, vertices)
+{
+    if (!m_outcome.ok())
+        m_outcome.raise();
+}
+
+ff::Polyhedron::Polyhedron(std::nothrow_t, const PolyhedralTopology& topology,
+                           const std::vector<R3>& vertices)
+    : m_sym_Ci(topology.symmetry_Ci)
+    , m_ownTopology(std::make_unique<const PolyhedralTopology>(topology))
+    , m_topology(m_ownTopology.get())
+    , m_nVertices(vertices.size())
+{
+    m_pointGroup = m_shapeGroup = &topologyGroup(m_sym_Ci);
+    m_outcome = build(vertices);
+}
+
+ff::Polyhedron::Polyhedron(std::nothrow_t, const PolyhedralTopology* topology,
+                           const std::vector<R3>& vertices)
+    : m_sym_Ci(topology->symmetry_Ci)
+    , m_topology(topology)
+    , m_nVertices(vertices.size())
+{
+    m_pointGroup = m_shapeGroup = &topologyGroup(m_sym_Ci);
+    m_outcome = build(vertices);
+}
+
+//! Computes the fan triangulation of all faces, from their first vertex, and its edges.
+//! Called once, on first use of the vertex gradient.
+
+void ff::Polyhedron::triangulate() const
+{
+    std::map<std::array<int, 2>, int> index;
+    const auto edge = [&](Triangle& t, int m) {
+        const int u = t.vertex[m];
+        const int v = t.vertex[(m + 1) % 3];
+        t.reversed[m] = u > v;
+        const std::array<int, 2> key = t.reversed[m] ? std::array<int, 2>{v, u}
+                                                     : std::array<int, 2>{u, v};
+        const auto it = index.emplace(key, static_cast<int>(m_triangleEdges.size())).first;
+        if (it->second == static_cast<int>(m_triangleEdges.size()))
+            m_triangleEdges.push_back(key);
+        t.edge[m] = it->second;
+    };
+    for (const PolygonalTopology& tf : m_topology->faces) {
+        const std::vector<int>& iv = tf.vertexIndices;
+        for (size_t i = 1; i + 1 < iv.size(); ++i) {
+            Triangle t;
+            t.vertex = {iv[0], iv[i], iv[i + 1]};
+            for (int m = 0; m < 3; ++m)
+                edge(t, m);
+            m_triangles.push_back(t);
+        }
+    }
+}
+
+//! Computes faces, edges and moments. Returns failure if the vertices do not form a valid
+//! polyhedron of the given topology.
+
+ff::Outcome ff::Polyhedron::build(const std::vector<R3>& vertices)
+{
+    const double diameter = polyhedralDiameter(vertices);
 
     m_faces.clear();
-    for (const PolygonalTopology& tf : topology.faces) {
+    size_t maxCorners = 0;
+    for (size_t k = 0; k < m_topology->faces.size(); ++k) {
+        const PolygonalTopology& tf = m_topology->faces[k];
         std::vector<R3> corners; // of one face
         for (int i : tf.vertexIndices)
             corners.push_back(vertices[i]);
-        if (PolyhedralFace::diameter(corners) <= 1e-14 * diameter)
+        maxCorners = std::max(maxCorners, corners.size());
+        if (PolyhedralFace::diameter(corners) <= 1e-14 * diameter) {
+            m_skippedFaces.push_back(k);
             continue; // skip ridiculously small face
-        m_faces.emplace_back(corners, tf.symmetry_S2);
+        }
+        Outcome outcome;
+        m_faces.emplace_back(corners, tf.symmetry_S2, outcome);
+        if (!outcome.ok())
+            return outcome;
+        m_faceIndex.push_back(k);
     }
+    m_corners.reserve(maxCorners);
     if (m_faces.size() < 4)
-        throw std::runtime_error("Invalid polyhedron: less than four non-vanishing faces");
+        return {Status::InvalidGeometry, "Invalid polyhedron: less than four non-vanishing faces"};
 
     m_radius = 0;
     m_volume = 0;
@@ -60,13 +226,234 @@ ff::Polyhedron::Polyhedron(const PolyhedralTopology& topology, const std::vector
     }
     if (m_sym_Ci) {
         if (m_faces.size() & 1)
-            throw std::runtime_error("Invalid polyhedron: odd #faces violates symmetry Ci");
+            return {Status::InvalidGeometry, "Invalid polyhedron: odd #faces violates symmetry Ci"};
         size_t N = m_faces.size() / 2;
         // for this tests, m_faces must be in a specific order
-        for (size_t k = 0; k < N; ++k)
-            m_faces[k].assert_Ci(m_faces[2 * N - 1 - k]);
-        // keep only half of the faces
+        for (size_t k = 0; k < N; ++k) {
+            const Outcome outcome = m_faces[k].check_Ci(m_faces[2 * N - 1 - k]);
+            if (!outcome.ok())
+                return outcome;
+        }
+    }
+    const std::vector<size_t> ids = edgeIds(vertices);
+    if (m_sym_Ci) { // keep only half of the faces
+        const size_t N = m_faces.size() / 2;
         m_faces.erase(m_faces.begin() + N, m_faces.end());
+        m_faceIndex.erase(m_faceIndex.begin() + N, m_faceIndex.end());
+    }
+    m_arrays = PolyhedralArrays(m_faces, ids);
+    m_vertices = vertices;
+    m_seriesOrder = m_accuracy.seriesOrder();
+    computeMoments();
+    return {};
+}
+
+//! Returns identifiers of the edges of the evaluated faces, taken from the vertex indices.
+
+//! Edges with equal identifiers border two faces, or with symmetry Ci are inverse to each
+//! other, and share their factors in PolyhedralArrays. Must be called before the inverted
+//! faces are dropped from m_faces: face k is the inverse of face 2N-1-k, and each vertex of
+//! face k is the inverse of the vertex of face 2N-1-k that is closest to its negative.
+//! Edges that are too short are skipped by the same criterion as in PolyhedralFace, and
+//! faces with symmetry S2 keep only the first half of their edges.
+
+std::vector<size_t> ff::Polyhedron::edgeIds(const std::vector<R3>& vertices) const
+{
+    const size_t nFaces = m_sym_Ci ? m_faces.size() / 2 : m_faces.size();
+    std::vector<int> inverse(vertices.size(), -1);
+    if (m_sym_Ci)
+        for (size_t k = 0; k < nFaces; ++k) {
+            const std::vector<int>& ia = m_topology->faces[m_faceIndex[k]].vertexIndices;
+            const std::vector<int>& ib =
+                m_topology->faces[m_faceIndex[m_faces.size() - 1 - k]].vertexIndices;
+            for (int a : ia) {
+                int best = ib[0];
+                for (int b : ib)
+                    if ((vertices[a] + vertices[b]).mag2() < (vertices[a] + vertices[best]).mag2())
+                        best = b;
+                inverse[a] = best;
+            }
+        }
+
+    const auto key = [](int a, int b) {
+        return a < b ? std::array<int, 2>{a, b} : std::array<int, 2>{b, a};
+    };
+    std::map<std::array<int, 2>, size_t> index;
+    std::vector<size_t> result;
+    for (size_t k = 0; k < nFaces; ++k) {
+        const std::vector<int>& iv = m_topology->faces[m_faceIndex[k]].vertexIndices;
+        const size_t NV = iv.size();
+        const size_t begin = result.size();
+        for (size_t j = 0; j < NV; ++j) {
+            const int a = iv[j];
+            const int b = iv[(j + 1) % NV];
+            if ((vertices[a] - vertices[b]).mag() < 1e-14 * m_faces[k].radius2d())
+                continue;
+            std::array<int, 2> e = key(a, b);
+            if (m_sym_Ci)
+                e = std::min(e, key(inverse[a], inverse[b]));
+            result.push_back(index.emplace(e, index.size()).first->second);
+        }
+        if (m_faces[k].symmetry_S2())
+            result.resize(begin + (result.size() - begin) / 2);
+    }
+    return result;
+}
+
+//! Moves the vertices, keeping the topology. Recomputes faces and edges in place.
+
+//! This is much cheaper than constructing a new polyhedron, as used in fitting loops.
+//! The checks done by the constructor are not repeated. Throws if the new vertices change
+//! the set of non-vanishing faces or edges; in that case a new Polyhedron must be constructed.
+//! Since the new vertices may break any symmetry, the point group is reset to the one known
+//! from the topology.
+
+void ff::Polyhedron::setVertices(const std::vector<R3>& vertices)
+{
+    const Outcome outcome = trySetVertices(vertices);
+    if (!outcome.ok())
+        outcome.raise();
+}
+
+//! Same as setVertices, but returns failure instead of throwing.
+
+//! After a failure, the polyhedron cannot be evaluated until vertices are set successfully:
+//! the throwing evaluation functions raise the failure, and the non-throwing formfactor
+//! reports it for each wavevector. Edge counts are compared against m_arrays, which keeps
+//! the last valid geometry.
+
+ff::Outcome ff::Polyhedron::trySetVertices(const std::vector<R3>& vertices)
+{
+    const Outcome outcome = trySetShapeVertices(vertices);
+    m_pointGroup = &topologyGroup(m_sym_Ci);
+    return outcome;
+}
+
+void ff::Polyhedron::setShapeVertices(const std::vector<R3>& vertices)
+{
+    const Outcome outcome = trySetShapeVertices(vertices);
+    if (!outcome.ok())
+        outcome.raise();
+}
+
+//! Same as trySetVertices, but sets the point group of the shape class.
+
+ff::Outcome ff::Polyhedron::trySetShapeVertices(const std::vector<R3>& vertices)
+{
+    m_pointGroup = m_shapeGroup;
+    if (m_arrays.nFaces() == 0) // construction has failed
+        return m_outcome;
+    m_outcome = setVerticesUnchecked(vertices);
+    return m_outcome;
+}
+
+ff::Outcome ff::Polyhedron::setVerticesUnchecked(const std::vector<R3>& vertices)
+{
+    if (vertices.size() != m_nVertices)
+        return {Status::InvalidArgument,
+                "Polyhedron::setVertices: number of vertices has changed"};
+
+    if (!m_skippedFaces.empty()) {
+        const double diameter = polyhedralDiameter(vertices);
+        for (size_t k : m_skippedFaces) {
+            m_corners.clear();
+            for (int i : m_topology->faces[k].vertexIndices)
+                m_corners.push_back(vertices[i]);
+            if (PolyhedralFace::diameter(m_corners) > 1e-14 * diameter)
+                return {Status::InvalidGeometry,
+                        "Polyhedron::setVertices: vanishing face has become finite"};
+        }
+    }
+
+    m_radius = 0;
+    m_volume = 0;
+    for (size_t k = 0; k < m_faces.size(); ++k) {
+        m_corners.clear();
+        for (int i : m_topology->faces[m_faceIndex[k]].vertexIndices)
+            m_corners.push_back(vertices[i]);
+        const Outcome outcome = m_faces[k].trySetVertices(m_corners);
+        if (!outcome.ok())
+            return outcome;
+        if (m_faces[k].nEdges() != m_arrays.face(k).nEdges())
+            return {Status::InvalidGeometry,
+                    "Polyhedron::setVertices: number of edges has changed"};
+        m_radius = std::max(m_radius, m_faces[k].radius3d());
+        m_volume += m_faces[k].pyramidalVolume();
+    }
+    if (m_sym_Ci)
+        m_volume *= 2; // inverted faces have the same pyramidal volume
+    m_arrays.assign(m_faces);
+    m_vertices = vertices;
+    computeMoments();
+    return {};
+}
+
+//! Computes the coefficients of the small-q polynomial F(q) = sum_n i^n int (q*r)^n/n! dV.
+
+//! The polyhedron is decomposed into tetrahedra (0, p, a, b), where p is the foot of the
+//! perpendicular from the origin onto a face, and (a, b) is an edge of that face. For such
+//! a tetrahedron, int (q*r)^n/n! dV = det(p,a,b)/(n+3)! h_n(q*p, q*a, q*b), where h_n is the
+//! complete homogeneous symmetric polynomial of degree n, obtained by the recurrence
+//! h_n(x_1..x_j) = h_n(x_1..x_j-1) + x_j h_n-1(x_1..x_j).
+
+void ff::Polyhedron::computeMoments()
+{
+    const int n_moments = std::max(m_seriesOrder, 2); // at least up to the inertia tensor
+    const size_t size = nMonomials(n_moments + 1);
+    m_moments.assign(size, 0.);
+    m_h1.resize(size);
+    m_h2.resize(size);
+    m_h3.resize(size);
+    m_h1[0] = m_h2[0] = m_h3[0] = 1;
+    auto addTetrahedron = [&](const R3& p, const R3& a, const R3& b) {
+        for (int n = 1; n <= n_moments; ++n) {
+            const size_t k0 = nMonomials(n - 1);
+            const size_t k1 = nMonomials(n);
+            std::fill(m_h1.begin() + k1, m_h1.begin() + nMonomials(n + 1), 0.);
+            addTimesLinear(&m_h1[k0], n - 1, p, &m_h1[k1]);
+            std::copy(m_h1.begin() + k1, m_h1.begin() + nMonomials(n + 1), m_h2.begin() + k1);
+            addTimesLinear(&m_h2[k0], n - 1, a, &m_h2[k1]);
+            std::copy(m_h2.begin() + k1, m_h2.begin() + nMonomials(n + 1), m_h3.begin() + k1);
+            addTimesLinear(&m_h3[k0], n - 1, b, &m_h3[k1]);
+        }
+        const double det = p.dot(a.cross(b)); // six times the signed volume
+        for (int n = 0; n <= n_moments; ++n)
+            for (size_t k = nMonomials(n); k < nMonomials(n + 1); ++k)
+                m_moments[k] += det * kernel::ReciprocalFactorialArray[n + 3] * m_h3[k];
+    };
+    for (const PolyhedralFace& Gk : m_faces) {
+        const R3 p = Gk.rperp() * Gk.normal();
+        for (size_t i = 0; i < Gk.nEdges(); ++i) {
+            const R3 a = Gk.R(i) - Gk.E(i);
+            const R3 b = Gk.R(i) + Gk.E(i);
+            addTetrahedron(p, a, b);
+            if (Gk.symmetry_S2()) // the edge obtained by inversion through p
+                addTetrahedron(p, 2 * p - a, 2 * p - b);
+        }
+    }
+    if (m_sym_Ci) // inverted faces contribute the same to even orders, and cancel odd orders
+        for (int n = 0; n <= n_moments; ++n)
+            for (size_t k = nMonomials(n); k < nMonomials(n + 1); ++k)
+                m_moments[k] = n & 1 ? 0 : 2 * m_moments[k];
+}
+
+//! Returns int x^a y^b z^c dV, for a+b+c <= 2.
+
+double ff::Polyhedron::moment(int a, int b, int c) const
+{
+    const auto& F = kernel::ReciprocalFactorialArray;
+    return m_moments[nMonomials(a + b + c) + monomialIndex(b + c, c)] / (F[a] * F[b] * F[c]);
+}
+
+//! Sets regime thresholds and series truncation. Throws if accuracy is out of range.
+
+void ff::Polyhedron::setAccuracy(const Accuracy& accuracy)
+{
+    accuracy.validate();
+    m_accuracy = accuracy;
+    if (m_accuracy.seriesOrder() != m_seriesOrder) {
+        m_seriesOrder = m_accuracy.seriesOrder();
+        computeMoments();
     }
 }
 
@@ -93,73 +480,502 @@ double ff::Polyhedron::radius() const
     return m_radius;
 }
 
+R3 ff::Polyhedron::centroid() const
+{
+    return R3(moment(1, 0, 0), moment(0, 1, 0), moment(0, 0, 1)) / m_volume;
+}
+
+double ff::Polyhedron::radiusOfGyration() const
+{
+    const double r2 = (moment(2, 0, 0) + moment(0, 2, 0) + moment(0, 0, 2)) / m_volume;
+    return std::sqrt(r2 - centroid().mag2());
+}
+
+std::array<R3, 3> ff::Polyhedron::inertiaTensor() const
+{
+    const R3 c = centroid();
+    // second moments about the centroid
+    const double xx = moment(2, 0, 0) - m_volume * c.x() * c.x();
+    const double yy = moment(0, 2, 0) - m_volume * c.y() * c.y();
+    const double zz = moment(0, 0, 2) - m_volume * c.z() * c.z();
+    const double xy = moment(1, 1, 0) - m_volume * c.x() * c.y();
+    const double xz = moment(1, 0, 1) - m_volume * c.x() * c.z();
+    const double yz = moment(0, 1, 1) - m_volume * c.y() * c.z();
+    return {R3(yy + zz, -xy, -xz), R3(-xy, xx + zz, -yz), R3(-xz, -yz, xx + yy)};
+}
+
 //! Returns the form factor F(q) of this polyhedron, with origin at z=0.
 
 complex_t ff::Polyhedron::formfactor(const C3& q) const
 {
+    if (!m_outcome.ok())
+        m_outcome.raise();
+    if (kernel::is_real(q))
+        return evaluate(q.real());
+    return evaluate(q);
+}
+
+//! Returns the form factor F(q) of this polyhedron, with origin at z=0, for real q.
+
+//! Same as formfactor(C3), but with real arithmetic wherever possible.
+
+complex_t ff::Polyhedron::formfactor(const R3& q) const
+{
+    if (!m_outcome.ok())
+        m_outcome.raise();
+    return evaluate(q);
+}
+
+//! If failed is given, a series expansion that does not converge sets *failed instead of
+//! throwing.
+
+template <class V> complex_t ff::Polyhedron::evaluate(const V& q, bool* failed) const
+{
+    Diagnostics* const diag = Diagnostics::active();
     double q_red = m_radius * q.mag();
-#ifdef ALGORITHM_DIAGNOSTIC
-    polyhedralDiagnosis.reset();
-#endif
-    if (q_red == 0)
+    if (q_red == 0) {
+        if (diag)
+            diag->countZero();
         return m_volume;
-    if (q_red < q_limit_series) {
-        // summation of power series
-#ifdef ALGORITHM_DIAGNOSTIC
-        polyhedralDiagnosis.algo = 100;
-#endif
-        complex_t sum = 0;
-        complex_t n_fac = (m_sym_Ci ? -2 : -1) / q.mag2();
-        int count_return_condition = 0;
-        for (int n = 2; n < n_limit_series; ++n) {
-            if (m_sym_Ci && n & 1)
-                continue;
-#ifdef ALGORITHM_DIAGNOSTIC
-            polyhedralDiagnosis.order = std::max(polyhedralDiagnosis.order, n);
-#endif
-            complex_t term = 0;
-            for (const PolyhedralFace& Gk : m_faces) {
-                complex_t tmp = Gk.ff_n(n + 1, q);
-                term += tmp;
+    }
+    if (q_red < m_accuracy.q_limit_series) {
+        if (diag)
+            diag->countSeries(m_seriesOrder);
+        return ff_series(q);
+    }
+
+    // direct evaluation of analytic formula (coefficients may involve series)
+    thread_local std::vector<complex_t> g;
+    g.resize(m_arrays.nSharedEdges());
+    kernel::shared_edge_factors(m_arrays, q, m_sym_Ci, g.data());
+    const size_t expansions = diag ? diag->expansions : 0;
+    complex_t sum = 0;
+    for (size_t k = 0; k < m_arrays.nFaces(); ++k)
+        sum += ff_face(k, q, g.data(), failed);
+    if (diag)
+        diag->countAnalytic(diag->expansions - expansions);
+    return sum / I / q.mag2();
+}
+
+//! Computes result[i] for the real wavevectors q[i], i in indices, by the given lockstep kernel.
+
+template <class Kernel>
+void ff::Polyhedron::lockstep(Kernel kernel, size_t W, const std::vector<size_t>& indices,
+                              const C3* q, complex_t* result, Status* status) const
+{
+    Diagnostics* const diag = Diagnostics::active();
+    std::vector<double> qx(W), qy(W), qz(W);
+    std::vector<complex_t> sum(W);
+    std::unique_ptr<bool[]> failed(status ? new bool[W] : nullptr);
+    for (size_t j0 = 0; j0 < indices.size(); j0 += W) {
+        const size_t nj = std::min(W, indices.size() - j0);
+        for (size_t l = 0; l < W; ++l) {
+            const C3& ql = q[indices[j0 + std::min(l, nj - 1)]]; // pad with last entry
+            qx[l] = ql.x().real();
+            qy[l] = ql.y().real();
+            qz[l] = ql.z().real();
+        }
+        if (status)
+            std::fill(failed.get(), failed.get() + W, false);
+        kernel(m_arrays, m_sym_Ci, m_accuracy, nj, qx.data(), qy.data(), qz.data(), sum.data(),
+               failed.get(), diag);
+        for (size_t l = 0; l < nj; ++l) {
+            const size_t i = indices[j0 + l];
+            result[i] = sum[l] / I / q[i].mag2();
+            if (status && failed[l])
+                status[i] = Status::NotConverged;
+        }
+    }
+}
+
+//! Computes the form factors F(q[i]) for n wavevectors, and writes them to result[i].
+
+//! Wavevectors are sorted by regime. Series evaluations are done point by point.
+//! Analytic evaluations of real wavevectors are done by the lockstep kernel, which
+//! processes several wavevectors at once with SIMD instructions, in single precision
+//! if so allowed by m_accuracy, or point by point if the library is compiled without
+//! SIMD instruction set. Analytic evaluations of complex wavevectors are done in blocks,
+//! face by face, so that the flattened edge arrays of one face stay in cache while they are
+//! applied to all wavevectors of the block.
+
+void ff::Polyhedron::formfactor(const C3* q, complex_t* result, size_t n) const
+{
+    if (!m_outcome.ok())
+        m_outcome.raise();
+    evaluateBatch(q, result, nullptr, n);
+}
+
+//! Wavevectors with non-finite components get status InvalidArgument. If construction or
+//! the latest change of vertices has failed, all wavevectors get the status of that failure.
+//! Exceptions that are not expected, like failure to allocate memory, yield status Failed.
+
+void ff::Polyhedron::formfactor(const C3* q, complex_t* result, Status* status,
+                                size_t n) const noexcept
+{
+    const complex_t nan(std::nan(""), std::nan(""));
+    if (!m_outcome.ok()) {
+        std::fill(result, result + n, nan);
+        std::fill(status, status + n, m_outcome.status);
+        return;
+    }
+    std::fill(status, status + n, Status::Ok);
+    try {
+        evaluateBatch(q, result, status, n);
+    } catch (...) {
+        std::fill(status, status + n, Status::Failed);
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (status[i] != Status::Ok)
+            result[i] = nan;
+}
+
+//! Implements both variants of the batch evaluation. If status is null, throws on failure;
+//! else sets status[i] for wavevectors that fail, and leaves the others untouched.
+
+void ff::Polyhedron::evaluateBatch(const C3* q, complex_t* result, Status* status,
+                                   size_t n) const
+{
+    Diagnostics* const diag = Diagnostics::active();
+    std::vector<size_t> analytic;        // indices of complex wavevectors
+    std::vector<size_t> analytic_real;   // indices of real wavevectors
+    std::vector<size_t> analytic_single; // same, to be computed in single precision
+    analytic.reserve(n);
+    analytic_real.reserve(n);
+    const bool mixed = m_accuracy.precision == Precision::Mixed;
+    for (size_t i = 0; i < n; ++i) {
+        double q_red = m_radius * q[i].mag();
+        if (status && !std::isfinite(q_red)) {
+            status[i] = Status::InvalidArgument;
+        } else if (q_red == 0) {
+            result[i] = m_volume;
+            if (diag)
+                diag->countZero();
+        } else if (q_red < m_accuracy.q_limit_series) {
+            result[i] = kernel::is_real(q[i]) ? ff_series(q[i].real()) : ff_series(q[i]);
+            if (diag)
+                diag->countSeries(m_seriesOrder);
+        } else if (!kernel::is_real(q[i])) {
+            result[i] = 0;
+            analytic.push_back(i);
+        } else if (!simd::vectorized()) {
+            bool failed = false;
+            result[i] = evaluate(q[i].real(), status ? &failed : nullptr);
+            if (failed)
+                status[i] = Status::NotConverged;
+        } else if (mixed && q_red >= m_accuracy.q_min_single && q_red <= m_accuracy.q_max_single)
+            analytic_single.push_back(i);
+        else
+            analytic_real.push_back(i);
+    }
+
+    lockstep(simd::analytic_sum, simd::lanes(), analytic_real, q, result, status);
+    lockstep(simd::analytic_sum_single, simd::lanes_single(), analytic_single, q, result, status);
+
+    // faces expanded per complex wavevector, only counted if diagnostics are recorded
+    std::vector<size_t> expanded(diag ? analytic.size() : 0);
+    std::unique_ptr<bool[]> failed(status ? new bool[analytic.size()]() : nullptr);
+    const size_t NS = m_arrays.nSharedEdges();
+    std::vector<complex_t> g(complexBlock * NS);
+    for (size_t j0 = 0; j0 < analytic.size(); j0 += complexBlock) {
+        const size_t j1 = std::min(j0 + complexBlock, analytic.size());
+        for (size_t j = j0; j < j1; ++j)
+            kernel::shared_edge_factors(m_arrays, q[analytic[j]], m_sym_Ci, &g[(j - j0) * NS]);
+        for (size_t k = 0; k < m_arrays.nFaces(); ++k)
+            for (size_t j = j0; j < j1; ++j) {
+                const size_t i = analytic[j];
+                const size_t expansions = diag ? diag->expansions : 0;
+                result[i] += ff_face(k, q[i], &g[(j - j0) * NS], failed ? &failed[j] : nullptr);
+                if (diag)
+                    expanded[j] += diag->expansions - expansions;
+            }
+    }
+    for (size_t j = 0; j < analytic.size(); ++j) {
+        const size_t i = analytic[j];
+        result[i] = result[i] / I / q[i].mag2();
+        if (failed && failed[j])
+            status[i] = Status::NotConverged;
+        if (diag)
+            diag->countAnalytic(expanded[j]);
+    }
+}
+
+//! Returns the form factors F(q) for a vector of wavevectors.
+
+std::vector<complex_t> ff::Polyhedron::formfactor(const std::vector<C3>& q) const
+{
+    std::vector<complex_t> result(q.size());
+    formfactor(q.data(), result.data(), q.size());
+    return result;
+}
+
+//! Computes the form factors F(q) for q = (t0+j*dt)*u, and writes them to result[j], j < n.
+
+//! Along such a ray, the trigonometric factors of the analytic formula are advanced from
+//! step to step by complex multiplication instead of fresh sine and cosine calls.
+//! Results agree with pointwise evaluation up to rounding, amplified by cancellations in
+//! the face sum.
+
+void ff::Polyhedron::formfactor_ray(const R3& u, double t0, double dt, complex_t* result,
+                                    size_t n) const
+{
+    if (!m_outcome.ok())
+        m_outcome.raise();
+    Diagnostics* const diag = Diagnostics::active();
+    std::vector<char> analytic(n);
+    for (size_t j = 0; j < n; ++j) {
+        const R3 q = (t0 + j * dt) * u;
+        double q_red = m_radius * q.mag();
+        if (q_red == 0) {
+            result[j] = m_volume;
+            if (diag)
+                diag->countZero();
+        } else if (q_red < m_accuracy.q_limit_series) {
+            result[j] = ff_series(q);
+            if (diag)
+                diag->countSeries(m_seriesOrder);
+        } else
+            analytic[j] = true;
+    }
+    ray::analytic_sum(m_arrays, m_sym_Ci, m_accuracy, u, t0, dt, n, analytic.data(), result,
+                      diag);
+    for (size_t j = 0; j < n; ++j)
+        if (analytic[j])
+            result[j] = result[j] / I / ((t0 + j * dt) * u).mag2();
+}
+
+//! Returns the form factors F(q) for q = (t0+j*dt)*u, j < n.
+
+std::vector<complex_t> ff::Polyhedron::formfactor_ray(const R3& u, double t0, double dt,
+                                                      size_t n) const
+{
+    std::vector<complex_t> result(n);
+    formfactor_ray(u, t0, dt, result.data(), n);
+    return result;
+}
+
+//! Returns F(q), and writes dF/dq to *dFdq, and dF/dv_j to dFdv[j] for the vertices v_j.
+
+//! The vertex gradient is that of the polyhedron whose faces are fan-triangulated from their
+//! first vertex. It is exact for all vertex motions that keep the faces planar, as do changes
+//! of shape parameters. With s_j = i q*v_j, a triangle (a,b,c) of outward normal
+//! n = (b-a)x(c-a) contributes n exp[s_a,s_a,s_b,s_c] to dF/dv_a. The phases e^s_j are
+//! computed once per vertex, and shared by all triangles.
+//!
+//! In the analytic regime, dF/dq follows from the vertex gradient through the scaling
+//! relation sum_j (dF/dv_j)_k v_j,l = delta_kl F + q_k dF/dq_l, contracted with
+//! conj(q)/|q|^2. Its relative accuracy degrades as 1/(q*radius)^2 towards the series
+//! regime, where dF/dq is obtained from the derivative of the power series.
+
+complex_t ff::Polyhedron::formfactor_gradient(const C3& q, C3* dFdq, C3* dFdv) const
+{
+    thread_local std::vector<C3> workspace;
+    const complex_t F = formfactor(q);
+    const bool series = m_radius * q.mag() < m_accuracy.q_limit_series;
+    if (!dFdv && (!dFdq || series)) {
+        if (dFdq)
+            *dFdq = ff_series_gradient(q);
+        return F;
+    }
+    if (!dFdv) {
+        workspace.resize(m_nVertices);
+        dFdv = workspace.data();
+    }
+    vertexGradient(q, dFdv);
+    if (!dFdq)
+        return F;
+    if (series) {
+        *dFdq = ff_series_gradient(q);
+        return F;
+    }
+    const C3 w = q.conj() / q.mag2();
+    complex_t G[3] = {-w.x() * F, -w.y() * F, -w.z() * F};
+    for (size_t j = 0; j < m_nVertices; ++j) {
+        const complex_t wg = w.x() * dFdv[j].x() + w.y() * dFdv[j].y() + w.z() * dFdv[j].z();
+        G[0] += wg * m_vertices[j].x();
+        G[1] += wg * m_vertices[j].y();
+        G[2] += wg * m_vertices[j].z();
+    }
+    *dFdq = C3(G[0], G[1], G[2]);
+    return F;
+}
+
+void ff::Polyhedron::chain(const C3* dFdv, const std::vector<std::vector<R3>>& J,
+                           complex_t* dFdp)
+{
+    for (size_t k = 0; k < J.size(); ++k) {
+        dFdp[k] = 0;
+        for (size_t j = 0; j < J[k].size(); ++j)
+            dFdp[k] += dFdv[j].x() * J[k][j].x() + dFdv[j].y() * J[k][j].y()
+                       + dFdv[j].z() * J[k][j].z();
+    }
+}
+
+//! Computes dF/dv_j, see formfactor_gradient.
+
+//! For a triangle (a,b,d) with |s_b-s_a| >= |s_d-s_a|, the divided difference
+//! exp[a,a,b,d] = (exp[a,b,d] - exp[a,a,d]) / (s_b-s_a) is computed from factors of the
+//! edges, exp[u,v], exp[u,u,v], exp[u,v,v] and 1/(s_v-s_u), which are shared by all
+//! triangles of an edge, and from exp[a,b,d], which is shared by the three vertices of the
+//! triangle, and is computed as a difference quotient along the edge of largest phase
+//! difference. Denominators are at least half the largest phase difference of the triangle.
+//! If that is below 1, a power series is used instead.
+
+void ff::Polyhedron::vertexGradient(const C3& q, C3* dFdv) const
+{
+    std::call_once(m_triangulated, [this] { triangulate(); });
+    const size_t NV = m_nVertices;
+    const size_t NE = m_triangleEdges.size();
+    thread_local std::vector<complex_t> workspace;
+    thread_local std::vector<double> norms;
+    workspace.resize(3 * NV + 5 * NE);
+    norms.resize(NE);
+    complex_t* const s = workspace.data(); // phases s_j = i q*v_j
+    complex_t* const e = s + NV;           // e^s_j
+    complex_t* const einv = e + NV;        // e^-s_j
+    // for the edges u -> v: z = s_v-s_u, 1/z, exp[u,v], exp[u,u,v], exp[u,v,v]
+    complex_t* const z = einv + NV;
+    complex_t* const zinv = z + NE;
+    complex_t* const uv = zinv + NE;
+    complex_t* const uuv = uv + NE;
+    complex_t* const uvv = uuv + NE;
+    double* const r2 = norms.data(); // |z|^2
+
+    for (size_t j = 0; j < NV; ++j) {
+        const R3& v = m_vertices[j];
+        s[j] = I * (q.x() * v.x() + q.y() * v.y() + q.z() * v.z());
+        e[j] = std::exp(s[j]);
+        einv[j] = inverse(e[j]);
+    }
+    for (size_t k = 0; k < NE; ++k) {
+        const int u = m_triangleEdges[k][0];
+        const int v = m_triangleEdges[k][1];
+        z[k] = s[v] - s[u];
+        r2[k] = std::norm(z[k]);
+        zinv[k] = r2[k] > 0 ? std::conj(z[k]) / r2[k] : 0.;
+        complex_t d1, d2;
+        expDividedDifferences(z[k], zinv[k], e[v] * einv[u], d1, d2);
+        uv[k] = e[u] * d1;
+        uuv[k] = e[u] * d2;
+        uvv[k] = e[u] * (d1 - d2);
+    }
+
+    std::fill(dFdv, dFdv + NV, C3());
+    for (const Triangle& t : m_triangles) {
+        const R3& v0 = m_vertices[t.vertex[0]];
+        const R3 n = (m_vertices[t.vertex[1]] - v0).cross(m_vertices[t.vertex[2]] - v0);
+        // for the edge from vertex[m] to vertex[m+1]: 1/(s_v-s_u), exp[u,u,v], exp[u,v,v]
+        complex_t inv[3], first[3], second[3];
+        double R2[3];
+        for (int m = 0; m < 3; ++m) {
+            const int k = t.edge[m];
+            R2[m] = r2[k];
+            inv[m] = t.reversed[m] ? -zinv[k] : zinv[k];
+            first[m] = t.reversed[m] ? uvv[k] : uuv[k];
+            second[m] = t.reversed[m] ? uuv[k] : uvv[k];
+        }
+        const int longest = R2[0] >= std::max(R2[1], R2[2]) ? 0 : R2[1] >= R2[2] ? 1 : 2;
+        if (R2[longest] <= 1) {
+            for (int m = 0; m < 3; ++m) {
+                const int a = t.vertex[m];
+                const complex_t x = s[t.vertex[(m + 1) % 3]] - s[a];
+                const complex_t y = s[t.vertex[(m + 2) % 3]] - s[a];
+                const complex_t w = e[a] * expDividedDifferenceSeries(x, y);
+                dFdv[a] += C3(w * n.x(), w * n.y(), w * n.z());
             }
-            term *= n_fac;
-#ifdef ALGORITHM_DIAGNOSTIC_LEVEL2
-            polyhedralDiagnosis.msg +=
-                boost::str(boost::format("  + term(n=%2i) = %23.17e+i*%23.17e\n") % n % term.real()
-                           % term.imag());
-#endif
-            sum += term;
-            if (std::abs(term) <= eps * std::abs(sum) || std::abs(sum) < eps * m_volume)
-                ++count_return_condition;
-            else
-                count_return_condition = 0;
-            if (count_return_condition > 2)
-                return m_volume + sum; // regular exit
-            n_fac = m_sym_Ci ? -n_fac : mul_I(n_fac);
+            continue;
+        }
+        // exp[a,b,d] = (exp[v,w] - exp[u,w]) / (s_v-s_u), with (u,v) the longest edge
+        const complex_t abd =
+            (uv[t.edge[(longest + 1) % 3]] - uv[t.edge[(longest + 2) % 3]]) * inv[longest];
+        for (int m = 0; m < 3; ++m) {
+            const int prev = (m + 2) % 3; // the edge from vertex[m+2] to vertex[m]
+            // exp[a,a,b,d], with a = vertex[m], b = vertex[m+1], d = vertex[m+2]
+            const complex_t w = R2[m] >= R2[prev] ? (abd - second[prev]) * inv[m]
+                                                  : (first[m] - abd) * inv[prev];
+            dFdv[t.vertex[m]] += C3(w * n.x(), w * n.y(), w * n.z());
         }
-        throw std::runtime_error("Numeric failure in polyhedron: series F(q) not converged");
     }
+}
 
-    // direct evaluation of analytic formula (coefficients may involve series)
-#ifdef ALGORITHM_DIAGNOSTIC
-    polyhedralDiagnosis.algo = 200;
-#endif
+//! Returns dF/dq from the derivative of the power series, see ff_series.
+
+C3 ff::Polyhedron::ff_series_gradient(const C3& q) const
+{
+    const int N = m_seriesOrder;
+    complex_t px[Accuracy::max_series_order + 1], py[Accuracy::max_series_order + 1],
+        pz[Accuracy::max_series_order + 1];
+    px[0] = py[0] = pz[0] = 1.;
+    for (int n = 1; n <= N; ++n) {
+        px[n] = px[n - 1] * q.x();
+        py[n] = py[n - 1] * q.y();
+        pz[n] = pz[n - 1] * q.z();
+    }
+    complex_t G[3] = {0, 0, 0};
+    complex_t i_n = I; // i^n
+    for (int n = 1; n <= N; ++n, i_n = mul_I(i_n)) {
+        if (m_sym_Ci && n & 1)
+            continue;
+        const double* C = &m_moments[nMonomials(n)];
+        complex_t term[3] = {0, 0, 0};
+        for (int m = 0; m <= n; ++m)
+            for (int c = 0; c <= m; ++c) {
+                const int a = n - m;
+                const int b = m - c;
+                const double M = *C++;
+                if (a)
+                    term[0] += M * a * px[a - 1] * py[b] * pz[c];
+                if (b)
+                    term[1] += M * b * px[a] * py[b - 1] * pz[c];
+                if (c)
+                    term[2] += M * c * px[a] * py[b] * pz[c - 1];
+            }
+        for (int k = 0; k < 3; ++k)
+            G[k] += i_n * term[k];
+    }
+    return C3(G[0], G[1], G[2]);
+}
+
+//! Returns F(q) from power series, for q_red < m_accuracy.q_limit_series.
+
+//! Evaluates the polynomial sum_n i^n sum_abc m_moments[abc] q_x^a q_y^b q_z^c.
+
+template <class V> complex_t ff::Polyhedron::ff_series(const V& q) const
+{
+    using T = kernel::scalar_t<V>;
+    const int N = m_seriesOrder;
+    T px[Accuracy::max_series_order + 1], py[Accuracy::max_series_order + 1],
+        pz[Accuracy::max_series_order + 1];
+    px[0] = py[0] = pz[0] = 1.;
+    for (int n = 1; n <= N; ++n) {
+        px[n] = px[n - 1] * q.x();
+        py[n] = py[n - 1] * q.y();
+        pz[n] = pz[n - 1] * q.z();
+    }
     complex_t sum = 0;
-    for (const PolyhedralFace& Gk : m_faces) {
-        complex_t qn = Gk.normalProjectionConj(q); // conj(q)*normal
-        if (std::abs(qn) < eps * q.mag())
+    complex_t i_n = 1; // i^n
+    for (int n = 0; n <= N; ++n, i_n = mul_I(i_n)) {
+        if (m_sym_Ci && n & 1)
             continue;
-        complex_t term = qn * Gk.ff(q, m_sym_Ci);
-#ifdef ALGORITHM_DIAGNOSTIC //_LEVEL2
-        polyhedralDiagnosis.msg += boost::str(boost::format("  + face_ff = %23.17e+i*%23.17e\n")
-                                              % term.real() % term.imag());
-#endif
-        sum += term;
-    }
-#ifdef ALGORITHM_DIAGNOSTIC //_LEVEL2
-    polyhedralDiagnosis.msg +=
-        boost::str(boost::format(" -> raw sum = %23.17e+i*%23.17e; divisor = %23.17e\n")
-                   % sum.real() % sum.imag() % q.mag2());
-#endif
-    return sum / I / q.mag2();
+        const double* C = &m_moments[nMonomials(n)];
+        T term = 0;
+        for (int m = 0; m <= n; ++m)
+            for (int c = 0; c <= m; ++c)
+                term += *C++ * px[n - m] * py[m - c] * pz[c];
+        sum += i_n * term;
+    }
+    return sum;
+}
+
+//! Returns the contribution of face k to the analytic sum, which is yet to be divided by i*q^2.
+
+//! Takes the shared edge factors g of the polyhedron at q, see kernel::shared_edge_factors.
+
+template <class V>
+complex_t ff::Polyhedron::ff_face(size_t k, const V& q, const complex_t* g, bool* failed) const
+{
+    const PolyhedralArrays::Face Gk = m_arrays.face(k);
+    kernel::scalar_t<V> qn = q.dot(Gk.normal()); // conj(q)*normal
+    if (std::abs(qn) < eps * q.mag())
+        return 0.;
+    return qn * kernel::ff(Gk, q, m_sym_Ci, m_accuracy, g, failed);
 }
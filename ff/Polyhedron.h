@@ -17,10 +17,17 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
 #include <vector>
 
+#include <ff/Accuracy.h>
+#include <ff/PointGroup.h>
+#include <ff/PolyhedralArrays.h>
 #include <ff/PolyhedralComponents.h>
 #include <ff/PolyhedralTopology.h>
+#include <ff/Status.h>
 #include <heinz/Complex.h>
 #include <heinz/Vectors3D.h>
 
@@ -31,22 +38,143 @@ namespace ff {
 class Polyhedron {
 public:
     Polyhedron(const PolyhedralTopology& topology, const std::vector<R3>& vertices);
+    //! Same as above, but records invalid vertices in outcome() instead of throwing.
+    Polyhedron(std::nothrow_t, const PolyhedralTopology& topology,
+               const std::vector<R3>& vertices);
     Polyhedron(const Polyhedron&) = delete;
 
+    //! Moves the vertices. Resets the point group to the one known from the topology.
+    void setVertices(const std::vector<R3>& vertices);
+    Outcome trySetVertices(const std::vector<R3>& vertices);
+    //! Returns the outcome of the construction, or of the latest change of vertices.
+    const Outcome& outcome() const { return m_outcome; }
+    size_t nVertices() const { return m_nVertices; }
+    void setAccuracy(const Accuracy& accuracy);
+    const Accuracy& accuracy() const { return m_accuracy; }
+
     void assert_platonic() const;
     double volume() const;
     double radius() const;
+    R3 centroid() const;
+    double radiusOfGyration() const;
+    //! Returns the rows of the inertia tensor about the centroid, for unit density.
+    std::array<R3, 3> inertiaTensor() const;
+    //! Returns the symmetry group of the shape. Shape classes set the group of their generic
+    //! parameters, which their setParameters preserves; otherwise, and after setVertices, it
+    //! is known only from the topology, as {1} or {1, -1}.
+    const PointGroup& pointGroup() const { return *m_pointGroup; }
 
     complex_t formfactor(const C3& q) const;
+    complex_t formfactor(const R3& q) const;
+    void formfactor(const C3* q, complex_t* result, size_t n) const;
+    //! Same as above, but never throws. Sets status[i] for each wavevector; unless it is Ok,
+    //! result[i] is NaN.
+    void formfactor(const C3* q, complex_t* result, Status* status, size_t n) const noexcept;
+    std::vector<complex_t> formfactor(const std::vector<C3>& q) const;
+    void formfactor_ray(const R3& u, double t0, double dt, complex_t* result, size_t n) const;
+    std::vector<complex_t> formfactor_ray(const R3& u, double t0, double dt, size_t n) const;
+    //! Returns F(q), and writes dF/dq to *dFdq, and dF/dv_j to dFdv[j] for the vertices v_j,
+    //! j < nVertices(). Either output may be null.
+    complex_t formfactor_gradient(const C3& q, C3* dFdq, C3* dFdv) const;
+    //! Writes dF/dp_k = sum_j dF/dv_j * J[k][j] to dFdp[k], where J = vertexJacobian(...).
+    static void chain(const C3* dFdv, const std::vector<std::vector<R3>>& J, complex_t* dFdp);
+
+protected:
+    //! Sets the point group of the shape class, which must outlive this polyhedron.
+    //! Same as the nothrow constructor above, but refers to topology instead of copying it.
+    //! For the static topologies of shape classes, which outlive every polyhedron.
+    Polyhedron(std::nothrow_t, const PolyhedralTopology* topology,
+               const std::vector<R3>& vertices);
+
+    void setPointGroup(const PointGroup& group) { m_pointGroup = m_shapeGroup = &group; }
+    //! Same as setVertices and trySetVertices, but set the point group of the shape class,
+    //! for use by shape classes whose parameters preserve it.
+    void setShapeVertices(const std::vector<R3>& vertices);
+    Outcome trySetShapeVertices(const std::vector<R3>& vertices);
 
 private:
     bool m_sym_Ci; //!< if true, then faces obtainable by inversion are not provided
 
+    //! Copy of a topology passed to a public constructor; null for shape classes
+    std::unique_ptr<const PolyhedralTopology> m_ownTopology;
+    const PolyhedralTopology* m_topology; //!< m_ownTopology, or the static one of a shape class
+    size_t m_nVertices;
+    std::vector<size_t> m_faceIndex;    //!< for each face in m_faces, index in m_topology->faces
+    std::vector<size_t> m_skippedFaces; //!< indices of faces skipped as ridiculously small
+    std::vector<R3> m_corners;          //!< workspace for setVertices
+    std::vector<R3> m_vertices;         //!< of the last valid geometry, for the gradient
+
+    //! Triangle of the fan triangulation of a face, used for the vertex gradient
+    struct Triangle {
+        std::array<int, 3> vertex;
+        std::array<int, 3> edge;      //!< index in m_triangleEdges of vertex[m] -> vertex[m+1]
+        std::array<bool, 3> reversed; //!< whether that edge is stored as vertex[m+1] -> vertex[m]
+    };
+    //! Fan triangulation, built by triangulate on first use of the vertex gradient, since it
+    //! depends on the topology only, and is not needed for the form factor
+    mutable std::once_flag m_triangulated;
+    mutable std::vector<Triangle> m_triangles;
+    mutable std::vector<std::array<int, 2>> m_triangleEdges; //!< distinct edges of m_triangles
+
     std::vector<PolyhedralFace> m_faces;
-    double m_radius;
-    double m_volume;
+    PolyhedralArrays m_arrays; //!< flattened copy of m_faces, used in evaluation
+    double m_radius = 0;
+    double m_volume = 0;
+    Accuracy m_accuracy;
+    int m_seriesOrder = 0; //!< order of the power series, from m_accuracy
+    //! Coefficients of the small-q polynomial: int x^a y^b z^c dV / (a!b!c!), by degree
+    std::vector<double> m_moments;
+    //! Workspaces for computeMoments, sized once per series order, so that setVertices does
+    //! not allocate: h_n of the first 1, 2, 3 arguments
+    std::vector<double> m_h1, m_h2, m_h3;
+    const PointGroup* m_pointGroup;
+    const PointGroup* m_shapeGroup; //!< as set by setPointGroup, restored by setShapeVertices
+    Outcome m_outcome;
+
+    Outcome build(const std::vector<R3>& vertices);
+    std::vector<size_t> edgeIds(const std::vector<R3>& vertices) const;
+    void triangulate() const;
+    Outcome setVerticesUnchecked(const std::vector<R3>& vertices);
+    void computeMoments();
+    double moment(int a, int b, int c) const;
+
+    // templated on the wavevector type, R3 or C3; defined and instantiated in Polyhedron.cpp
+    template <class V> complex_t evaluate(const V& q, bool* failed = nullptr) const;
+    template <class V> complex_t ff_series(const V& q) const;
+    C3 ff_series_gradient(const C3& q) const;
+    void vertexGradient(const C3& q, C3* dFdv) const;
+    template <class V>
+    complex_t ff_face(size_t k, const V& q, const complex_t* g, bool* failed) const;
+    template <class Kernel>
+    void lockstep(Kernel kernel, size_t W, const std::vector<size_t>& indices, const C3* q,
+                  complex_t* result, Status* status) const;
+    void evaluateBatch(const C3* q, complex_t* result, Status* status, size_t n) const;
 };
 
+//! Returns the derivatives J[k][j] = dv_j/dp_k of the vertices v_j = vertices(p...) with
+//! respect to the parameters p_k, for use in Polyhedron::chain.
+
+//! The vertex function must be affine in each parameter, as are the vertices, vertices2 and
+//! vertices3 functions of all shape classes, so that a difference quotient is exact up to
+//! rounding. Example: vertexJacobian(&cuboid::Pave::vertices3, a, b, c).
+
+template <class... P>
+std::vector<std::vector<R3>> vertexJacobian(std::vector<R3> (*vertices)(P...), P... p)
+{
+    const std::array<double, sizeof...(P)> p0{p...};
+    const std::vector<R3> v0 = vertices(p...);
+    std::vector<std::vector<R3>> result(p0.size());
+    for (size_t k = 0; k < p0.size(); ++k) {
+        std::array<double, sizeof...(P)> p1 = p0;
+        const double h = p0[k] != 0 ? p0[k] : 1.; // so that p1[k] - p0[k] is exact
+        p1[k] += h;
+        const std::vector<R3> v1 = std::apply(vertices, p1);
+        for (size_t j = 0; j < v0.size(); ++j)
+            result[k].push_back((v1[j] - v0[j]) / h);
+    }
+    return result;
+}
+
 } // namespace ff
 
 #endif // FORMFACTOR_FF_POLYHEDRON_H
@@ -17,59 +17,247 @@
 //! "Form factor (Fourier shape transform) of polygon and polyhedron."
 
 #include "ff/Prism.h"
+#include "ff/PolyhedralKernels.h"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 namespace {
 
-complex_t sinc(const complex_t z) // cardinal sine function, sin(x)/x
-{
-    if (z == complex_t(0., 0.))
-        return 1.0;
-    return std::sin(z) / z;
-}
-
-} // namespace
-
+//! Rethrows the exception that is currently handled, with a message that points to Prism.
 
-ff::Prism::Prism(bool symmetry_Ci, double height, const std::vector<R3>& vertices)
+[[noreturn]] void rethrowFromPrism()
 {
-    m_height = height;
-
     try {
-        m_base = std::make_unique<ff::PolyhedralFace>(vertices, symmetry_Ci);
-    } catch (std::invalid_argument& e) {
-        throw std::invalid_argument(std::string("Invalid parameterization of Prism: ") + e.what());
+        throw;
     } catch (std::logic_error& e) {
         throw std::logic_error(std::string("Bug in Prism: ") + e.what()
                                + " [please report to the maintainers]");
+    } catch (std::runtime_error& e) {
+        throw std::runtime_error(std::string("Numeric computation failed in Prism: ") + e.what()
+                                 + " [please report to the maintainers]");
     } catch (std::exception& e) {
         throw std::runtime_error(std::string("Unexpected exception in Prism: ") + e.what()
                                  + " [please report to the maintainers]");
     }
 }
 
+//! Throws the exception that corresponds to a failed construction.
+
+[[noreturn]] void raiseFromPrism(const ff::Outcome& outcome)
+{
+    if (outcome.status == ff::Status::InvalidArgument)
+        throw std::invalid_argument(std::string("Invalid parameterization of Prism: ")
+                                    + outcome.message);
+    throw std::runtime_error(std::string("Unexpected exception in Prism: ") + outcome.message
+                             + " [please report to the maintainers]");
+}
+
+} // namespace
+
+
+ff::Prism::Prism(bool symmetry_Ci, double height, const std::vector<R3>& vertices)
+    : Prism(std::nothrow, symmetry_Ci, height, vertices)
+{
+    if (!m_outcome.ok())
+        raiseFromPrism(m_outcome);
+}
+
+ff::Prism::Prism(std::nothrow_t, bool symmetry_Ci, double height,
+                 const std::vector<R3>& vertices)
+    : m_height(height)
+{
+    Outcome outcome;
+    m_base = std::make_unique<ff::PolyhedralFace>(vertices, symmetry_Ci, outcome);
+    m_outcome = outcome;
+}
+
+//! Sets regime threshold and series truncation. Throws if accuracy is out of range.
+
+void ff::Prism::setAccuracy(const Accuracy& accuracy)
+{
+    accuracy.validate();
+    m_accuracy = accuracy;
+}
+
 double ff::Prism::area() const
 {
     return m_base->area();
 }
 
+//! Returns the radius of the enclosing sphere, centered at the origin.
+
+double ff::Prism::radius() const
+{
+    return std::hypot(m_base->radius3d(), m_height / 2);
+}
+
 complex_t ff::Prism::formfactor(const C3& q) const
 {
+    if (!m_outcome.ok())
+        raiseFromPrism(m_outcome);
     try {
-#ifdef ALGORITHM_DIAGNOSTIC
-        polyhedralDiagnosis.reset();
-        polyhedralDiagnosis.algo = 500;
-#endif
-        C3 qxy(q.x(), q.y(), 0.);
-        return m_height * sinc(m_height / 2 * q.z()) * m_base->ff_2D(qxy);
-    } catch (std::logic_error& e) {
-        throw std::logic_error(std::string("Bug in Prism: ") + e.what()
-                               + " [please report to the maintainers]");
-    } catch (std::runtime_error& e) {
-        throw std::runtime_error(std::string("Numeric computation failed in Prism: ") + e.what()
-                                 + " [please report to the maintainers]");
-    } catch (std::exception& e) {
-        throw std::runtime_error(std::string("Unexpected exception in Prism: ") + e.what()
-                                 + " [please report to the maintainers]");
+        if (kernel::is_real(q))
+            return ff_unchecked(q.real());
+        return ff_unchecked(q);
+    } catch (...) {
+        rethrowFromPrism();
     }
 }
+
+//! Returns the form factor F(q) for real q, with real arithmetic wherever possible.
+
+complex_t ff::Prism::formfactor(const R3& q) const
+{
+    if (!m_outcome.ok())
+        raiseFromPrism(m_outcome);
+    try {
+        return ff_unchecked(q);
+    } catch (...) {
+        rethrowFromPrism();
+    }
+}
+
+//! Computes the form factors F(q[i]) for n wavevectors, and writes them to result[i].
+
+void ff::Prism::formfactor(const C3* q, complex_t* result, size_t n) const
+{
+    if (!m_outcome.ok())
+        raiseFromPrism(m_outcome);
+    try {
+        evaluateBatch(q, result, nullptr, n);
+    } catch (...) {
+        rethrowFromPrism();
+    }
+}
+
+//! Wavevectors with non-finite components get status InvalidArgument. If construction has
+//! failed, all wavevectors get the status of that failure. Exceptions that are not expected,
+//! like failure to allocate memory, yield status Failed.
+
+void ff::Prism::formfactor(const C3* q, complex_t* result, Status* status,
+                           size_t n) const noexcept
+{
+    const complex_t nan(std::nan(""), std::nan(""));
+    if (!m_outcome.ok()) {
+        std::fill(result, result + n, nan);
+        std::fill(status, status + n, m_outcome.status);
+        return;
+    }
+    std::fill(status, status + n, Status::Ok);
+    try {
+        evaluateBatch(q, result, status, n);
+    } catch (...) {
+        std::fill(status, status + n, Status::Failed);
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (status[i] != Status::Ok)
+            result[i] = nan;
+}
+
+//! Returns the form factors F(q) for a vector of wavevectors.
+
+std::vector<complex_t> ff::Prism::formfactor(const std::vector<C3>& q) const
+{
+    std::vector<complex_t> result(q.size());
+    formfactor(q.data(), result.data(), q.size());
+    return result;
+}
+
+//! Computes the outer product of the polygon transform of the base for the in-plane
+//! wavevectors qxy[i], and of height * sinc(height/2 * qz[j]).
+
+//! Transcendental functions are evaluated nxy + nz times, instead of nxy * nz times in
+//! pointwise evaluation. Results agree with batch evaluation up to rounding. Diagnostics are
+//! the same as well: an expansion of the base, shared by a row of nz wavevectors, is
+//! recorded nz times.
+
+void ff::Prism::formfactor_grid(const C3* qxy, size_t nxy, const complex_t* qz, size_t nz,
+                                complex_t* result) const
+{
+    if (!m_outcome.ok())
+        raiseFromPrism(m_outcome);
+    try {
+        Diagnostics* const diag = Diagnostics::active();
+        std::vector<complex_t> qz_half(nz);
+        std::vector<complex_t> fz(nz);
+        for (size_t j = 0; j < nz; ++j)
+            qz_half[j] = m_height / 2 * qz[j];
+        ff_aux::sinc(qz_half.data(), fz.data(), nz);
+        for (size_t j = 0; j < nz; ++j)
+            fz[j] = m_height * fz[j];
+        std::vector<size_t> orders; // expansionOrder before the current row
+        for (size_t i = 0; i < nxy; ++i) {
+            const C3 q(qxy[i].x(), qxy[i].y(), 0.);
+            const size_t expansions = diag ? diag->expansions : 0;
+            if (diag)
+                orders = diag->expansionOrder;
+            const complex_t ff_2D = kernel::is_real(q)
+                                        ? kernel::ff_2D(*m_base, q.real(), m_accuracy)
+                                        : kernel::ff_2D(*m_base, q, m_accuracy);
+            complex_t* const row = result + i * nz;
+            for (size_t j = 0; j < nz; ++j)
+                row[j] = fz[j] * ff_2D;
+            if (diag && nz) {
+                const size_t expanded = diag->expansions - expansions;
+                diag->repeatExpansions(orders, nz - 1);
+                for (size_t j = 0; j < nz; ++j)
+                    diag->countPrism(expanded);
+            }
+        }
+    } catch (...) {
+        rethrowFromPrism();
+    }
+}
+
+//! Returns the form factors for the grid qxy x qz, with qz running fastest.
+
+std::vector<complex_t> ff::Prism::formfactor_grid(const std::vector<C3>& qxy,
+                                                  const std::vector<complex_t>& qz) const
+{
+    std::vector<complex_t> result(qxy.size() * qz.size());
+    formfactor_grid(qxy.data(), qxy.size(), qz.data(), qz.size(), result.data());
+    return result;
+}
+
+//! Implements both variants of the batch evaluation. If status is null, throws on failure;
+//! else sets status[i] for wavevectors that fail, and leaves the others untouched.
+
+void ff::Prism::evaluateBatch(const C3* q, complex_t* result, Status* status, size_t n) const
+{
+    Diagnostics* const diag = Diagnostics::active();
+    std::vector<complex_t> qz_half(n);
+    for (size_t i = 0; i < n; ++i)
+        qz_half[i] = m_height / 2 * q[i].z();
+    ff_aux::sinc(qz_half.data(), result, n);
+    for (size_t i = 0; i < n; ++i) {
+        if (status && !std::isfinite(q[i].mag())) {
+            status[i] = Status::InvalidArgument;
+            continue;
+        }
+        C3 qxy(q[i].x(), q[i].y(), 0.);
+        bool failed = false;
+        bool* const f = status ? &failed : nullptr;
+        const size_t expansions = diag ? diag->expansions : 0;
+        const complex_t ff_2D = kernel::is_real(qxy)
+                                    ? kernel::ff_2D(*m_base, qxy.real(), m_accuracy, f)
+                                    : kernel::ff_2D(*m_base, qxy, m_accuracy, f);
+        result[i] = m_height * result[i] * ff_2D;
+        if (failed)
+            status[i] = Status::NotConverged;
+        if (diag)
+            diag->countPrism(diag->expansions - expansions);
+    }
+}
+
+template <class V> complex_t ff::Prism::ff_unchecked(const V& q) const
+{
+    Diagnostics* const diag = Diagnostics::active();
+    const size_t expansions = diag ? diag->expansions : 0;
+    V qxy(q.x(), q.y(), 0.);
+    const complex_t result =
+        m_height * ff_aux::sinc(m_height / 2 * q.z()) * m_base->ff_2D(qxy, m_accuracy);
+    if (diag)
+        diag->countPrism(diag->expansions - expansions);
+    return result;
+}
@@ -17,21 +17,48 @@
 
 #include "ff/PolyhedralComponents.h"
 #include "ff/PolyhedralTopology.h"
+#include "ff/Status.h"
 #include <memory>
+#include <new>
 
 namespace ff {
 
 class Prism {
 public:
     Prism(bool symmetry_Ci, double height, const std::vector<R3>& vertices);
+    //! Same as above, but records an invalid base in outcome() instead of throwing.
+    Prism(std::nothrow_t, bool symmetry_Ci, double height, const std::vector<R3>& vertices);
     Prism(const Prism&) = delete;
 
+    const Outcome& outcome() const { return m_outcome; }
+
+    void setAccuracy(const Accuracy& accuracy);
+    const Accuracy& accuracy() const { return m_accuracy; }
+
     double area() const;
+    double radius() const;
     complex_t formfactor(const C3& q) const;
+    complex_t formfactor(const R3& q) const;
+    void formfactor(const C3* q, complex_t* result, size_t n) const;
+    //! Same as above, but never throws. Sets status[i] for each wavevector; unless it is Ok,
+    //! result[i] is NaN.
+    void formfactor(const C3* q, complex_t* result, Status* status, size_t n) const noexcept;
+    std::vector<complex_t> formfactor(const std::vector<C3>& q) const;
+    //! Computes F for the wavevectors (qxy[i].x, qxy[i].y, qz[j]), and writes them to
+    //! result[i*nz+j], for i < nxy and j < nz. The z components of qxy are ignored.
+    void formfactor_grid(const C3* qxy, size_t nxy, const complex_t* qz, size_t nz,
+                         complex_t* result) const;
+    std::vector<complex_t> formfactor_grid(const std::vector<C3>& qxy,
+                                           const std::vector<complex_t>& qz) const;
 
 private:
     std::unique_ptr<ff::PolyhedralFace> m_base;
     double m_height;
+    Accuracy m_accuracy;
+    Outcome m_outcome;
+
+    template <class V> complex_t ff_unchecked(const V& q) const;
+    void evaluateBatch(const C3* q, complex_t* result, Status* status, size_t n) const;
 };
 
 } // namespace ff
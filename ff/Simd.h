@@ -0,0 +1,482 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Simd.h
+//! @brief     Defines SIMD packs of doubles and floats, and vectorized real sine and cosine.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+//! For internal use in the lockstep kernels.
+//!
+//! The pack width depends on the instruction set the library is compiled for:
+//! 8 lanes with AVX-512, 4 lanes with AVX2, else 4 lanes of plain arrays,
+//! to be vectorized by the compiler as far as possible. Float packs have twice as many lanes
+//! as double packs, width_f = 2*width.
+
+#ifndef FORMFACTOR_FF_SIMD_H
+#define FORMFACTOR_FF_SIMD_H
+
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ff::simd {
+
+#if defined(__AVX512F__)
+
+constexpr bool is_vectorized = true;
+constexpr int width = 8;
+
+struct Md {
+    __mmask8 m;
+    int bits() const { return m; }
+};
+
+struct Vd {
+    __m512d v;
+    Vd() = default;
+    Vd(__m512d _v) : v(_v) {}
+    Vd(double a) : v(_mm512_set1_pd(a)) {}
+    static Vd load(const double* p) { return _mm512_loadu_pd(p); }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+};
+
+inline Vd operator+(Vd a, Vd b) { return _mm512_add_pd(a.v, b.v); }
+inline Vd operator-(Vd a, Vd b) { return _mm512_sub_pd(a.v, b.v); }
+inline Vd operator*(Vd a, Vd b) { return _mm512_mul_pd(a.v, b.v); }
+inline Vd operator/(Vd a, Vd b) { return _mm512_div_pd(a.v, b.v); }
+inline Vd operator-(Vd a) { return _mm512_sub_pd(_mm512_setzero_pd(), a.v); }
+inline Vd abs(Vd a) { return _mm512_abs_pd(a.v); }
+// The unmasked intrinsics sqrt, roundscale, cvtps and extract of GCC pass an uninitialized
+// source operand, which triggers -Wuninitialized once inlined; hence masked intrinsics with
+// all lanes set, which compile to the same instructions.
+inline Vd sqrt(Vd a) { return _mm512_mask_sqrt_pd(a.v, 0xFF, a.v); }
+inline Vd round(Vd a)
+{
+    return _mm512_mask_roundscale_pd(a.v, 0xFF, a.v, _MM_FROUND_TO_NEAREST_INT);
+}
+inline Vd floor(Vd a)
+{
+    return _mm512_mask_roundscale_pd(a.v, 0xFF, a.v, _MM_FROUND_TO_NEG_INF);
+}
+inline Md operator<(Vd a, Vd b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline Md operator==(Vd a, Vd b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ)}; }
+inline Md operator&(Md a, Md b) { return {static_cast<__mmask8>(a.m & b.m)}; }
+inline Md operator|(Md a, Md b) { return {static_cast<__mmask8>(a.m | b.m)}; }
+inline Md operator!(Md a) { return {static_cast<__mmask8>(~a.m)}; }
+//! Returns a where m is set, else b.
+inline Vd select(Md m, Vd a, Vd b) { return _mm512_mask_blend_pd(m.m, b.v, a.v); }
+
+constexpr int width_f = 16;
+
+struct Mf {
+    __mmask16 m;
+    int bits() const { return m; }
+};
+
+struct Vf {
+    __m512 v;
+    Vf() = default;
+    Vf(__m512 _v) : v(_v) {}
+    Vf(float a) : v(_mm512_set1_ps(a)) {}
+    static Vf load(const float* p) { return _mm512_loadu_ps(p); }
+    void store(float* p) const { _mm512_storeu_ps(p, v); }
+};
+
+inline Vf operator+(Vf a, Vf b) { return _mm512_add_ps(a.v, b.v); }
+inline Vf operator-(Vf a, Vf b) { return _mm512_sub_ps(a.v, b.v); }
+inline Vf operator*(Vf a, Vf b) { return _mm512_mul_ps(a.v, b.v); }
+inline Vf operator/(Vf a, Vf b) { return _mm512_div_ps(a.v, b.v); }
+inline Vf operator-(Vf a) { return _mm512_sub_ps(_mm512_setzero_ps(), a.v); }
+inline Vf abs(Vf a) { return _mm512_abs_ps(a.v); }
+inline Vf sqrt(Vf a) { return _mm512_mask_sqrt_ps(a.v, 0xFFFF, a.v); }
+inline Vf round(Vf a)
+{
+    return _mm512_mask_roundscale_ps(a.v, 0xFFFF, a.v, _MM_FROUND_TO_NEAREST_INT);
+}
+inline Vf floor(Vf a)
+{
+    return _mm512_mask_roundscale_ps(a.v, 0xFFFF, a.v, _MM_FROUND_TO_NEG_INF);
+}
+inline Mf operator<(Vf a, Vf b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mf operator==(Vf a, Vf b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)}; }
+inline Mf operator&(Mf a, Mf b) { return {static_cast<__mmask16>(a.m & b.m)}; }
+inline Mf operator|(Mf a, Mf b) { return {static_cast<__mmask16>(a.m | b.m)}; }
+inline Mf operator!(Mf a) { return {static_cast<__mmask16>(~a.m)}; }
+//! Returns a where m is set, else b.
+inline Vf select(Mf m, Vf a, Vf b) { return _mm512_mask_blend_ps(m.m, b.v, a.v); }
+//! Converts the lower and upper half of a to double.
+inline void widen(Vf a, Vd& lo, Vd& hi)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    const __m256d zero_half = _mm256_setzero_pd();
+    const __m512d d = _mm512_castps_pd(a.v);
+    const __m256 a_lo = _mm256_castpd_ps(_mm512_mask_extractf64x4_pd(zero_half, 0xF, d, 0));
+    const __m256 a_hi = _mm256_castpd_ps(_mm512_mask_extractf64x4_pd(zero_half, 0xF, d, 1));
+    lo = _mm512_mask_cvtps_pd(zero, 0xFF, a_lo);
+    hi = _mm512_mask_cvtps_pd(zero, 0xFF, a_hi);
+}
+
+#elif defined(__AVX2__)
+
+constexpr bool is_vectorized = true;
+constexpr int width = 4;
+
+struct Md {
+    __m256d m;
+    int bits() const { return _mm256_movemask_pd(m); }
+};
+
+struct Vd {
+    __m256d v;
+    Vd() = default;
+    Vd(__m256d _v) : v(_v) {}
+    Vd(double a) : v(_mm256_set1_pd(a)) {}
+    static Vd load(const double* p) { return _mm256_loadu_pd(p); }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+};
+
+inline Vd operator+(Vd a, Vd b) { return _mm256_add_pd(a.v, b.v); }
+inline Vd operator-(Vd a, Vd b) { return _mm256_sub_pd(a.v, b.v); }
+inline Vd operator*(Vd a, Vd b) { return _mm256_mul_pd(a.v, b.v); }
+inline Vd operator/(Vd a, Vd b) { return _mm256_div_pd(a.v, b.v); }
+inline Vd operator-(Vd a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.)); }
+inline Vd abs(Vd a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), a.v); }
+inline Vd sqrt(Vd a) { return _mm256_sqrt_pd(a.v); }
+inline Vd round(Vd a)
+{
+    return _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline Vd floor(Vd a) { return _mm256_floor_pd(a.v); }
+inline Md operator<(Vd a, Vd b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline Md operator==(Vd a, Vd b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)}; }
+inline Md operator&(Md a, Md b) { return {_mm256_and_pd(a.m, b.m)}; }
+inline Md operator|(Md a, Md b) { return {_mm256_or_pd(a.m, b.m)}; }
+inline Md operator!(Md a)
+{
+    return {_mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))};
+}
+//! Returns a where m is set, else b.
+inline Vd select(Md m, Vd a, Vd b) { return _mm256_blendv_pd(b.v, a.v, m.m); }
+
+constexpr int width_f = 8;
+
+struct Mf {
+    __m256 m;
+    int bits() const { return _mm256_movemask_ps(m); }
+};
+
+struct Vf {
+    __m256 v;
+    Vf() = default;
+    Vf(__m256 _v) : v(_v) {}
+    Vf(float a) : v(_mm256_set1_ps(a)) {}
+    static Vf load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline Vf operator+(Vf a, Vf b) { return _mm256_add_ps(a.v, b.v); }
+inline Vf operator-(Vf a, Vf b) { return _mm256_sub_ps(a.v, b.v); }
+inline Vf operator*(Vf a, Vf b) { return _mm256_mul_ps(a.v, b.v); }
+inline Vf operator/(Vf a, Vf b) { return _mm256_div_ps(a.v, b.v); }
+inline Vf operator-(Vf a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.f)); }
+inline Vf abs(Vf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+inline Vf sqrt(Vf a) { return _mm256_sqrt_ps(a.v); }
+inline Vf round(Vf a)
+{
+    return _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline Vf floor(Vf a) { return _mm256_floor_ps(a.v); }
+inline Mf operator<(Vf a, Vf b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mf operator==(Vf a, Vf b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)}; }
+inline Mf operator&(Mf a, Mf b) { return {_mm256_and_ps(a.m, b.m)}; }
+inline Mf operator|(Mf a, Mf b) { return {_mm256_or_ps(a.m, b.m)}; }
+inline Mf operator!(Mf a)
+{
+    return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))};
+}
+//! Returns a where m is set, else b.
+inline Vf select(Mf m, Vf a, Vf b) { return _mm256_blendv_ps(b.v, a.v, m.m); }
+//! Converts the lower and upper half of a to double.
+inline void widen(Vf a, Vd& lo, Vd& hi)
+{
+    lo = _mm256_cvtps_pd(_mm256_castps256_ps128(a.v));
+    hi = _mm256_cvtps_pd(_mm256_extractf128_ps(a.v, 1));
+}
+
+#else
+
+//! Plain arrays are hardly vectorized at -O2, and the lockstep kernel is then slower than
+//! the scalar one.
+constexpr bool is_vectorized = false;
+constexpr int width = 4;
+constexpr int width_f = 2 * width;
+
+//! Mask of N lanes.
+template <int N> struct Mask {
+    static constexpr int size = N;
+    bool m[N];
+    int bits() const
+    {
+        int result = 0;
+        for (int l = 0; l < N; ++l)
+            result |= m[l] << l;
+        return result;
+    }
+};
+
+//! Pack of N lanes of type T.
+template <class T, int N> struct Pack {
+    static constexpr int size = N;
+    T v[N];
+    Pack() = default;
+    Pack(T a)
+    {
+        for (int l = 0; l < N; ++l)
+            v[l] = a;
+    }
+    static Pack load(const T* p)
+    {
+        Pack result;
+        for (int l = 0; l < N; ++l)
+            result.v[l] = p[l];
+        return result;
+    }
+    void store(T* p) const
+    {
+        for (int l = 0; l < N; ++l)
+            p[l] = v[l];
+    }
+};
+
+using Md = Mask<width>;
+using Vd = Pack<double, width>;
+using Mf = Mask<width_f>;
+using Vf = Pack<float, width_f>;
+
+#define FF_SIMD_LANEWISE(T, expr)                                                                  \
+    T result;                                                                                      \
+    for (int l = 0; l < T::size; ++l)                                                              \
+        result.expr;                                                                               \
+    return result;
+
+inline Vd operator+(Vd a, Vd b) { FF_SIMD_LANEWISE(Vd, v[l] = a.v[l] + b.v[l]) }
+inline Vd operator-(Vd a, Vd b) { FF_SIMD_LANEWISE(Vd, v[l] = a.v[l] - b.v[l]) }
+inline Vd operator*(Vd a, Vd b) { FF_SIMD_LANEWISE(Vd, v[l] = a.v[l] * b.v[l]) }
+inline Vd operator/(Vd a, Vd b) { FF_SIMD_LANEWISE(Vd, v[l] = a.v[l] / b.v[l]) }
+inline Vd operator-(Vd a) { FF_SIMD_LANEWISE(Vd, v[l] = -a.v[l]) }
+inline Vd abs(Vd a) { FF_SIMD_LANEWISE(Vd, v[l] = std::abs(a.v[l])) }
+inline Vd sqrt(Vd a) { FF_SIMD_LANEWISE(Vd, v[l] = std::sqrt(a.v[l])) }
+inline Vd round(Vd a) { FF_SIMD_LANEWISE(Vd, v[l] = std::nearbyint(a.v[l])) }
+inline Vd floor(Vd a) { FF_SIMD_LANEWISE(Vd, v[l] = std::floor(a.v[l])) }
+inline Md operator<(Vd a, Vd b) { FF_SIMD_LANEWISE(Md, m[l] = a.v[l] < b.v[l]) }
+inline Md operator==(Vd a, Vd b) { FF_SIMD_LANEWISE(Md, m[l] = a.v[l] == b.v[l]) }
+inline Md operator&(Md a, Md b) { FF_SIMD_LANEWISE(Md, m[l] = a.m[l] && b.m[l]) }
+inline Md operator|(Md a, Md b) { FF_SIMD_LANEWISE(Md, m[l] = a.m[l] || b.m[l]) }
+inline Md operator!(Md a) { FF_SIMD_LANEWISE(Md, m[l] = !a.m[l]) }
+//! Returns a where m is set, else b.
+inline Vd select(Md m, Vd a, Vd b) { FF_SIMD_LANEWISE(Vd, v[l] = m.m[l] ? a.v[l] : b.v[l]) }
+
+inline Vf operator+(Vf a, Vf b) { FF_SIMD_LANEWISE(Vf, v[l] = a.v[l] + b.v[l]) }
+inline Vf operator-(Vf a, Vf b) { FF_SIMD_LANEWISE(Vf, v[l] = a.v[l] - b.v[l]) }
+inline Vf operator*(Vf a, Vf b) { FF_SIMD_LANEWISE(Vf, v[l] = a.v[l] * b.v[l]) }
+inline Vf operator/(Vf a, Vf b) { FF_SIMD_LANEWISE(Vf, v[l] = a.v[l] / b.v[l]) }
+inline Vf operator-(Vf a) { FF_SIMD_LANEWISE(Vf, v[l] = -a.v[l]) }
+inline Vf abs(Vf a) { FF_SIMD_LANEWISE(Vf, v[l] = std::abs(a.v[l])) }
+inline Vf sqrt(Vf a) { FF_SIMD_LANEWISE(Vf, v[l] = std::sqrt(a.v[l])) }
+inline Vf round(Vf a) { FF_SIMD_LANEWISE(Vf, v[l] = std::nearbyint(a.v[l])) }
+inline Vf floor(Vf a) { FF_SIMD_LANEWISE(Vf, v[l] = std::floor(a.v[l])) }
+inline Mf operator<(Vf a, Vf b) { FF_SIMD_LANEWISE(Mf, m[l] = a.v[l] < b.v[l]) }
+inline Mf operator==(Vf a, Vf b) { FF_SIMD_LANEWISE(Mf, m[l] = a.v[l] == b.v[l]) }
+inline Mf operator&(Mf a, Mf b) { FF_SIMD_LANEWISE(Mf, m[l] = a.m[l] && b.m[l]) }
+inline Mf operator|(Mf a, Mf b) { FF_SIMD_LANEWISE(Mf, m[l] = a.m[l] || b.m[l]) }
+inline Mf operator!(Mf a) { FF_SIMD_LANEWISE(Mf, m[l] = !a.m[l]) }
+//! Returns a where m is set, else b.
+inline Vf select(Mf m, Vf a, Vf b) { FF_SIMD_LANEWISE(Vf, v[l] = m.m[l] ? a.v[l] : b.v[l]) }
+//! Converts the lower and upper half of a to double.
+inline void widen(Vf a, Vd& lo, Vd& hi)
+{
+    for (int l = 0; l < width; ++l) {
+        lo.v[l] = a.v[l];
+        hi.v[l] = a.v[width + l];
+    }
+}
+
+#undef FF_SIMD_LANEWISE
+
+#endif
+
+inline Vd& operator+=(Vd& a, Vd b)
+{
+    return a = a + b;
+}
+
+inline Vd& operator-=(Vd& a, Vd b)
+{
+    return a = a - b;
+}
+
+inline Vf& operator+=(Vf& a, Vf b)
+{
+    return a = a + b;
+}
+
+inline Vf& operator-=(Vf& a, Vf b)
+{
+    return a = a - b;
+}
+
+inline bool any(Md m)
+{
+    return m.bits() != 0;
+}
+
+inline bool any(Mf m)
+{
+    return m.bits() != 0;
+}
+
+//! Computes s=sin(x) and c=cos(x) for all lanes.
+
+//! Argument reduction by Cody-Waite with pi/2 split into three parts of 33 bits,
+//! followed by the minimax polynomials of fdlibm's __kernel_sin and __kernel_cos,
+//! evaluated with the tail of the reduced argument. Lanes with |x| > 2^19*pi/2,
+//! or with non-finite x, are passed to std::sin and std::cos.
+
+inline void sincos(Vd x, Vd& s, Vd& c)
+{
+    const double invpio2 = 6.36619772367581382433e-01;
+    const double pio2_1 = 1.57079632673412561417e+00;  // first 33 bits of pi/2
+    const double pio2_2 = 6.07710050630396597660e-11;  // second 33 bits of pi/2
+    const double pio2_3 = 2.02226624871116645580e-21;  // third 33 bits of pi/2
+    const double S1 = -1.66666666666666324348e-01;
+    const double S2 = 8.33333333332248946124e-03;
+    const double S3 = -1.98412698298579493134e-04;
+    const double S4 = 2.75573137070700676789e-06;
+    const double S5 = -2.50507602534068634195e-08;
+    const double S6 = 1.58969099521155010221e-10;
+    const double C1 = 4.16666666666666019037e-02;
+    const double C2 = -1.38888888888741095749e-03;
+    const double C3 = 2.48015872894767294178e-05;
+    const double C4 = -2.75573143513906633035e-07;
+    const double C5 = 2.08757232129817482790e-09;
+    const double C6 = -1.13596475577881948265e-11;
+    const double xmax = 8.23549664582e5; // 2^19*pi/2
+
+    const Md in_range = abs(x) < Vd(xmax); // false for NaN
+    const Vd xr = select(in_range, x, Vd(0.));
+
+    // reduce to r+y with |r+y| <= pi/4, where y is the tail of r
+    const Vd n = round(xr * Vd(invpio2));
+    const Vd r1 = (xr - n * Vd(pio2_1)) - n * Vd(pio2_2);
+    const Vd w = n * Vd(pio2_3);
+    const Vd r = r1 - w;
+    const Vd y = (r1 - r) - w;
+
+    // kernels
+    const Vd z = r * r;
+    const Vd zz = z * z;
+    const Vd v = z * r;
+    const Vd rs = Vd(S2) + z * (Vd(S3) + z * Vd(S4)) + z * zz * (Vd(S5) + z * Vd(S6));
+    const Vd sin_r = r - ((z * (Vd(0.5) * y - v * rs) - y) - v * Vd(S1));
+    const Vd rc = z * (Vd(C1) + z * (Vd(C2) + z * Vd(C3)))
+                  + zz * zz * (Vd(C4) + z * (Vd(C5) + z * Vd(C6)));
+    const Vd hz = Vd(0.5) * z;
+    const Vd ww = Vd(1.) - hz;
+    const Vd cos_r = ww + (((Vd(1.) - ww) - hz) + (z * rc - r * y));
+
+    // select by quadrant
+    const Vd quadrant = n - Vd(4.) * floor(n * Vd(0.25));
+    const Md odd = (quadrant == Vd(1.)) | (quadrant == Vd(3.));
+    const Md sin_neg = !(quadrant < Vd(2.));
+    const Md cos_neg = (quadrant == Vd(1.)) | (quadrant == Vd(2.));
+    const Vd s0 = select(odd, cos_r, sin_r);
+    const Vd c0 = select(odd, sin_r, cos_r);
+    s = select(sin_neg, -s0, s0);
+    c = select(cos_neg, -c0, c0);
+
+    if (!any(!in_range))
+        return;
+    double xa[width], sa[width], ca[width];
+    x.store(xa);
+    s.store(sa);
+    c.store(ca);
+    for (int l = 0; l < width; ++l) {
+        if (std::abs(xa[l]) < xmax)
+            continue;
+        sa[l] = std::sin(xa[l]);
+        ca[l] = std::cos(xa[l]);
+    }
+    s = Vd::load(sa);
+    c = Vd::load(ca);
+}
+
+//! Computes s=sin(x) and c=cos(x) for all lanes, in single precision.
+
+//! Argument reduction by Cody-Waite with pi/2 split into three parts, followed by the
+//! minimax polynomials of Cephes' sinf and cosf. Lanes with |x| > 8192, or with non-finite
+//! x, are passed to std::sin and std::cos.
+
+inline void sincos(Vf x, Vf& s, Vf& c)
+{
+    const float invpio2 = 0.636619772367581343f;
+    const float pio2_1 = 1.5703125f;
+    const float pio2_2 = 4.837512969970703125e-4f;
+    const float pio2_3 = 7.54978995489188216e-8f;
+    const float S1 = -1.6666654611e-1f;
+    const float S2 = 8.3321608736e-3f;
+    const float S3 = -1.9515295891e-4f;
+    const float C1 = 4.166664568298827e-2f;
+    const float C2 = -1.388731625493765e-3f;
+    const float C3 = 2.443315711809948e-5f;
+    const float xmax = 8192.f;
+
+    const Mf in_range = abs(x) < Vf(xmax); // false for NaN
+    const Vf xr = select(in_range, x, Vf(0.f));
+
+    // reduce to r with |r| <= pi/4
+    const Vf n = round(xr * Vf(invpio2));
+    const Vf r = ((xr - n * Vf(pio2_1)) - n * Vf(pio2_2)) - n * Vf(pio2_3);
+
+    // kernels
+    const Vf z = r * r;
+    const Vf sin_r = r + r * z * (Vf(S1) + z * (Vf(S2) + z * Vf(S3)));
+    const Vf cos_r = Vf(1.f) - Vf(0.5f) * z + z * z * (Vf(C1) + z * (Vf(C2) + z * Vf(C3)));
+
+    // select by quadrant
+    const Vf quadrant = n - Vf(4.f) * floor(n * Vf(0.25f));
+    const Mf odd = (quadrant == Vf(1.f)) | (quadrant == Vf(3.f));
+    const Mf sin_neg = !(quadrant < Vf(2.f));
+    const Mf cos_neg = (quadrant == Vf(1.f)) | (quadrant == Vf(2.f));
+    const Vf s0 = select(odd, cos_r, sin_r);
+    const Vf c0 = select(odd, sin_r, cos_r);
+    s = select(sin_neg, -s0, s0);
+    c = select(cos_neg, -c0, c0);
+
+    if (!any(!in_range))
+        return;
+    float xa[width_f], sa[width_f], ca[width_f];
+    x.store(xa);
+    s.store(sa);
+    c.store(ca);
+    for (int l = 0; l < width_f; ++l) {
+        if (std::abs(xa[l]) < xmax)
+            continue;
+        sa[l] = static_cast<float>(std::sin(static_cast<double>(xa[l])));
+        ca[l] = static_cast<float>(std::cos(static_cast<double>(xa[l])));
+    }
+    s = Vf::load(sa);
+    c = Vf::load(ca);
+}
+
+} // namespace ff::simd
+
+#endif // FORMFACTOR_FF_SIMD_H
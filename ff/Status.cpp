@@ -0,0 +1,23 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Status.cpp
+//! @brief     Implements struct Outcome.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/Status.h"
+#include <stdexcept>
+
+void ff::Outcome::raise() const
+{
+    if (status == Status::InvalidArgument)
+        throw std::invalid_argument(message);
+    throw std::runtime_error(message);
+}
@@ -0,0 +1,78 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/Status.h
+//! @brief     Defines enum Status, struct Outcome, and the non-throwing factory make.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_STATUS_H
+#define FORMFACTOR_FF_STATUS_H
+
+#include <memory>
+#include <new>
+
+namespace ff {
+
+//! Result of an operation of the non-throwing API.
+
+enum class Status : unsigned char {
+    Ok,
+    InvalidArgument, //!< degenerate parameters, e.g. zero edge length, or non-finite q
+    InvalidGeometry, //!< vertices do not form a valid polyhedron, e.g. a face is not planar
+    NotConverged,    //!< a power series in q_pa did not converge
+    Failed           //!< any other error, e.g. memory allocation failed
+};
+
+//! Status of an operation, with a message if it failed.
+
+//! The throwing API raises the same messages, as std::invalid_argument if the status is
+//! InvalidArgument, and as std::runtime_error otherwise.
+
+struct Outcome {
+    Status status = Status::Ok;
+    const char* message = ""; //!< a string literal
+
+    bool ok() const { return status == Status::Ok; }
+    //! Throws the exception that corresponds to status and message.
+    [[noreturn]] void raise() const;
+};
+
+//! Expected-style result of a non-throwing construction.
+
+template <class T> struct Expected {
+    std::unique_ptr<T> value; //!< nullptr unless outcome.ok()
+    Outcome outcome;
+
+    explicit operator bool() const { return outcome.ok(); }
+};
+
+//! Constructs a shape of class S from its parameters, without throwing.
+
+//! S must have a constructor S(std::nothrow_t, parameters...) that records failure in
+//! outcome() instead of throwing, as have Polyhedron and all shape classes.
+
+template <class S, class... P> Expected<S> make(P... parameters) noexcept
+{
+    Expected<S> result;
+    try {
+        result.value = std::make_unique<S>(std::nothrow, parameters...);
+    } catch (...) {
+        result.outcome = {Status::Failed, "Construction failed: out of memory"};
+        return result;
+    }
+    result.outcome = result.value->outcome();
+    if (!result.outcome.ok())
+        result.value.reset();
+    return result;
+}
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_STATUS_H
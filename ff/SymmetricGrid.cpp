@@ -0,0 +1,136 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/SymmetricGrid.cpp
+//! @brief     Implements class SymmetricGrid.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/SymmetricGrid.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/Polyhedron.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+//! Number of wavevectors used to decide whether a group element maps the grid onto itself.
+const size_t nSamples = 64;
+
+//! A wavevector, rounded to integer multiples of a fixed step.
+using Key = std::array<long long, 3>;
+
+struct KeyHash {
+    size_t operator()(const Key& k) const
+    {
+        size_t h = std::hash<long long>()(k[0]);
+        h = h * 1000003 ^ std::hash<long long>()(k[1]);
+        return h * 1000003 ^ std::hash<long long>()(k[2]);
+    }
+};
+
+//! A Laue group element, q -> sign*g*q, with F(sign*g*q) = conj(F(q)) if sign < 0.
+struct Operation {
+    ff::PointGroup::Matrix g;
+    bool conj;
+};
+
+} // namespace
+
+
+//! Each wavevector that is not yet assigned to an orbit becomes the representative of a new
+//! orbit, and is mapped by all used group elements. Images that are found among the
+//! unassigned wavevectors join the orbit.
+
+ff::SymmetricGrid::SymmetricGrid(const PointGroup& group, const std::vector<R3>& q)
+    : m_group(group)
+    , m_source(q.size())
+    , m_conj(q.size(), false)
+{
+    double scale = 0;
+    for (const R3& qi : q)
+        scale = std::max({scale, std::abs(qi.x()), std::abs(qi.y()), std::abs(qi.z())});
+    const double step = scale > 0 ? 1e-13 * scale : 1.;
+    const auto key = [step](const R3& v) -> Key {
+        return {std::llround(v.x() / step), std::llround(v.y() / step),
+                std::llround(v.z() / step)};
+    };
+    std::unordered_map<Key, size_t, KeyHash> index;
+    index.reserve(q.size());
+    for (size_t i = 0; i < q.size(); ++i)
+        index.emplace(key(q[i]), i);
+    const auto find = [&](const R3& v) {
+        const auto it = index.find(key(v));
+        return it == index.end() ? q.size() : it->second;
+    };
+
+    // the Laue group without identity; elements of the point group first, so that
+    // conjugation is only used where needed
+    std::vector<Operation> ops;
+    for (size_t k = 1; k < group.order(); ++k)
+        ops.push_back({group.elements()[k], false});
+    if (!group.hasInversion())
+        for (const PointGroup::Matrix& g : group.elements())
+            ops.push_back({{-1. * g[0], -1. * g[1], -1. * g[2]}, true});
+
+    // keep the operations that map a sample of the wavevectors onto the grid
+    const size_t stride = std::max<size_t>(1, q.size() / nSamples);
+    ops.erase(std::remove_if(ops.begin(), ops.end(),
+                             [&](const Operation& op) {
+                                 size_t n = 0;
+                                 size_t hits = 0;
+                                 for (size_t i = 0; i < q.size(); i += stride, ++n)
+                                     hits += find(PointGroup::apply(op.g, q[i])) < q.size();
+                                 return 4 * hits < n;
+                             }),
+              ops.end());
+
+    const size_t unassigned = q.size();
+    std::fill(m_source.begin(), m_source.end(), unassigned);
+    for (size_t i = 0; i < q.size(); ++i) {
+        if (m_source[i] != unassigned)
+            continue;
+        const size_t u = m_unique.size();
+        m_unique.emplace_back(q[i].x(), q[i].y(), q[i].z());
+        m_source[i] = u;
+        for (const Operation& op : ops) {
+            const size_t j = find(PointGroup::apply(op.g, q[i]));
+            if (j < q.size() && m_source[j] == unassigned) {
+                m_source[j] = u;
+                m_conj[j] = op.conj;
+            }
+        }
+    }
+}
+
+void ff::SymmetricGrid::formfactor(const Polyhedron& p, complex_t* result,
+                                   ParallelEvaluator* pe) const
+{
+    if (!p.pointGroup().includes(m_group))
+        throw std::invalid_argument(
+            "SymmetricGrid::formfactor: polyhedron lacks the symmetry of the grid");
+    std::vector<complex_t> F(m_unique.size());
+    if (pe)
+        pe->formfactor(p, m_unique.data(), F.data(), m_unique.size());
+    else
+        p.formfactor(m_unique.data(), F.data(), m_unique.size());
+    for (size_t i = 0; i < m_source.size(); ++i)
+        result[i] = m_conj[i] ? std::conj(F[m_source[i]]) : F[m_source[i]];
+}
+
+std::vector<complex_t> ff::SymmetricGrid::formfactor(const Polyhedron& p,
+                                                     ParallelEvaluator* pe) const
+{
+    std::vector<complex_t> result(m_source.size());
+    formfactor(p, result.data(), pe);
+    return result;
+}
@@ -0,0 +1,66 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/SymmetricGrid.h
+//! @brief     Defines class SymmetricGrid.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_SYMMETRICGRID_H
+#define FORMFACTOR_FF_SYMMETRICGRID_H
+
+#include <ff/PointGroup.h>
+#include <heinz/Complex.h>
+#include <heinz/Vectors3D.h>
+#include <vector>
+
+namespace ff {
+
+class ParallelEvaluator;
+class Polyhedron;
+
+//! A set of real wavevectors, reduced to orbits under the Laue group of a polyhedron, so that
+//! the form factor is evaluated once per orbit.
+
+//! Two wavevectors are in the same orbit if q' = g*q, where F(q') = F(q), or q' = -g*q, where
+//! F(q') = conj(F(q)), for an element g of the point group. Wavevectors are matched after
+//! rounding to 1e-13 of the largest coordinate. Group elements that are signed permutations,
+//! as in Cartesian grids and cubic shapes, map grid points exactly onto each other; other
+//! elements only help on grids that share the symmetry, such as polar grids around the
+//! symmetry axis. Elements under which less than a quarter of a sample of wavevectors is
+//! mapped onto the grid are not used.
+//!
+//! The reduction is computed once, and can be reused for all polyhedra whose point group
+//! includes the one given, e.g. in a fit of the parameters of a shape class.
+
+class SymmetricGrid {
+public:
+    SymmetricGrid(const PointGroup& group, const std::vector<R3>& q);
+
+    size_t size() const { return m_source.size(); }
+    //! Number of wavevectors at which the form factor is evaluated.
+    size_t nUnique() const { return m_unique.size(); }
+    const PointGroup& group() const { return m_group; }
+
+    //! Computes F(q[i]) for all wavevectors, and writes them to result[i]. Unique wavevectors
+    //! are evaluated on the threads of pe, or serially if pe=nullptr. Throws unless the point
+    //! group of p includes group().
+    void formfactor(const Polyhedron& p, complex_t* result, ParallelEvaluator* pe = nullptr) const;
+    std::vector<complex_t> formfactor(const Polyhedron& p, ParallelEvaluator* pe = nullptr) const;
+
+private:
+    PointGroup m_group;
+    std::vector<C3> m_unique;     //!< one representative per orbit
+    std::vector<size_t> m_source; //!< for each wavevector, index of its representative
+    std::vector<bool> m_conj;     //!< for each wavevector, whether F is conjugated
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_SYMMETRICGRID_H
@@ -0,0 +1,150 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/TransformedPolyhedron.cpp
+//! @brief     Implements struct AffineMap and class TransformedPolyhedron.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#include "ff/TransformedPolyhedron.h"
+#include "ff/Math.h"
+#include "ff/Polyhedron.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+//! Returns A^T q, where A is given by its rows.
+C3 transposedTimes(const std::array<R3, 3>& A, const C3& q)
+{
+    return {q.x() * A[0].x() + q.y() * A[1].x() + q.z() * A[2].x(),
+            q.x() * A[0].y() + q.y() * A[1].y() + q.z() * A[2].y(),
+            q.x() * A[0].z() + q.y() * A[1].z() + q.z() * A[2].z()};
+}
+
+//! Returns |det A| exp(i q*t), the factor between F(A^T q) and the transformed form factor.
+complex_t prefactor(const ff::AffineMap& m, const C3& q)
+{
+    return std::abs(m.determinant()) * ff_aux::exp_I(m.t.dot(q));
+}
+
+} // namespace
+
+//  ************************************************************************************************
+//  struct AffineMap
+//  ************************************************************************************************
+
+ff::AffineMap ff::AffineMap::scaling(double s)
+{
+    return scaling(s, s, s);
+}
+
+ff::AffineMap ff::AffineMap::scaling(double sx, double sy, double sz)
+{
+    AffineMap result;
+    result.A = {R3(sx, 0, 0), R3(0, sy, 0), R3(0, 0, sz)};
+    return result;
+}
+
+ff::AffineMap ff::AffineMap::rotation(const R3& axis, double angle)
+{
+    const R3 n = axis.unit();
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    const double C = 1 - c;
+    AffineMap result;
+    result.A = {R3(c + n.x() * n.x() * C, n.x() * n.y() * C - n.z() * s,
+                   n.x() * n.z() * C + n.y() * s),
+                R3(n.y() * n.x() * C + n.z() * s, c + n.y() * n.y() * C,
+                   n.y() * n.z() * C - n.x() * s),
+                R3(n.z() * n.x() * C - n.y() * s, n.z() * n.y() * C + n.x() * s,
+                   c + n.z() * n.z() * C)};
+    return result;
+}
+
+ff::AffineMap ff::AffineMap::translation(const R3& t)
+{
+    AffineMap result;
+    result.t = t;
+    return result;
+}
+
+double ff::AffineMap::determinant() const
+{
+    return A[0].dot(A[1].cross(A[2]));
+}
+
+ff::AffineMap ff::AffineMap::operator*(const AffineMap& other) const
+{
+    AffineMap result;
+    for (int i = 0; i < 3; ++i) {
+        const R3 col(other.A[0][i], other.A[1][i], other.A[2][i]);
+        for (int j = 0; j < 3; ++j)
+            result.A[j][i] = A[j].dot(col);
+    }
+    result.t = R3(A[0].dot(other.t), A[1].dot(other.t), A[2].dot(other.t)) + t;
+    return result;
+}
+
+//  ************************************************************************************************
+//  class TransformedPolyhedron
+//  ************************************************************************************************
+
+ff::TransformedPolyhedron::TransformedPolyhedron(std::shared_ptr<const Polyhedron> polyhedron,
+                                                 const AffineMap& map)
+    : m_polyhedron(std::move(polyhedron))
+    , m_map(map)
+{
+    if (!m_polyhedron)
+        throw std::invalid_argument("Invalid transformed polyhedron: no polyhedron given");
+    if (m_map.determinant() == 0)
+        throw std::invalid_argument("Invalid transformed polyhedron: singular linear map");
+}
+
+double ff::TransformedPolyhedron::volume() const
+{
+    return std::abs(m_map.determinant()) * m_polyhedron->volume();
+}
+
+complex_t ff::TransformedPolyhedron::formfactor(const C3& q) const
+{
+    return prefactor(m_map, q) * m_polyhedron->formfactor(transposedTimes(m_map.A, q));
+}
+
+//! Computes the form factors F(q[i]) for n wavevectors, and writes them to result[i].
+
+void ff::TransformedPolyhedron::formfactor(const C3* q, complex_t* result, size_t n) const
+{
+    std::vector<C3> q_mapped(n);
+    for (size_t i = 0; i < n; ++i)
+        q_mapped[i] = transposedTimes(m_map.A, q[i]);
+    m_polyhedron->formfactor(q_mapped.data(), result, n);
+    for (size_t i = 0; i < n; ++i)
+        result[i] *= prefactor(m_map, q[i]);
+}
+
+//! Returns the form factors F(q) for a vector of wavevectors.
+
+std::vector<complex_t> ff::TransformedPolyhedron::formfactor(const std::vector<C3>& q) const
+{
+    std::vector<complex_t> result(q.size());
+    formfactor(q.data(), result.data(), q.size());
+    return result;
+}
+
+void ff::TransformedPolyhedron::formfactor_ensemble(const Polyhedron& p, const AffineMap* maps,
+                                                    size_t n, const C3& q, complex_t* result)
+{
+    std::vector<C3> q_mapped(n);
+    for (size_t i = 0; i < n; ++i)
+        q_mapped[i] = transposedTimes(maps[i].A, q);
+    p.formfactor(q_mapped.data(), result, n);
+    for (size_t i = 0; i < n; ++i)
+        result[i] *= prefactor(maps[i], q);
+}
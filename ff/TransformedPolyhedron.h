@@ -0,0 +1,74 @@
+//  ************************************************************************************************
+//
+//  libformfactor: efficient and accurate computation of scattering form factors
+//
+//! @file      ff/TransformedPolyhedron.h
+//! @brief     Defines struct AffineMap and class TransformedPolyhedron.
+//!
+//! @homepage  https://jugit.fz-juelich.de/mlz/libformfactor
+//! @license   GNU General Public License v3 or higher (see LICENSE)
+//! @copyright Forschungszentrum Jülich GmbH 2022
+//! @author    Joachim Wuttke, Scientific Computing Group at MLZ (see CITATION)
+//
+//  ************************************************************************************************
+
+#ifndef FORMFACTOR_FF_TRANSFORMEDPOLYHEDRON_H
+#define FORMFACTOR_FF_TRANSFORMEDPOLYHEDRON_H
+
+#include <heinz/Complex.h>
+#include <heinz/Vectors3D.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace ff {
+
+class Polyhedron;
+
+//! Affine map r -> A*r + t.
+
+struct AffineMap {
+    std::array<R3, 3> A{R3(1, 0, 0), R3(0, 1, 0), R3(0, 0, 1)}; //!< rows of the linear part
+    R3 t{0, 0, 0};                                               //!< translation
+
+    static AffineMap scaling(double s);
+    static AffineMap scaling(double sx, double sy, double sz);
+    //! Rotation by angle (in radians) around axis, counterclockwise when viewed against axis.
+    static AffineMap rotation(const R3& axis, double angle);
+    static AffineMap translation(const R3& t);
+
+    double determinant() const;
+    //! Returns the map that applies first other, then this.
+    AffineMap operator*(const AffineMap& other) const;
+};
+
+//! View of a shared, immutable Polyhedron under an affine map.
+
+//! The form factor of the mapped shape is F'(q) = |det A| exp(i q*t) F(A^T q), so that no
+//! faces need to be rebuilt. Many views can share one Polyhedron, which is useful for
+//! polydisperse or randomly oriented ensembles.
+
+class TransformedPolyhedron {
+public:
+    TransformedPolyhedron(std::shared_ptr<const Polyhedron> polyhedron, const AffineMap& map);
+
+    const Polyhedron& polyhedron() const { return *m_polyhedron; }
+    const AffineMap& map() const { return m_map; }
+    double volume() const;
+
+    complex_t formfactor(const C3& q) const;
+    void formfactor(const C3* q, complex_t* result, size_t n) const;
+    std::vector<complex_t> formfactor(const std::vector<C3>& q) const;
+
+    //! Computes the form factors of polyhedron p under maps[i], at fixed q, for i < n.
+    static void formfactor_ensemble(const Polyhedron& p, const AffineMap* maps, size_t n,
+                                    const C3& q, complex_t* result);
+
+private:
+    std::shared_ptr<const Polyhedron> m_polyhedron;
+    AffineMap m_map;
+};
+
+} // namespace ff
+
+#endif // FORMFACTOR_FF_TRANSFORMEDPOLYHEDRON_H
@@ -20,16 +20,20 @@ namespace ff::tri {
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology TriangularBipyramid::topology()
-
+constexpr StaticTopology<6, 3> triangularBipyramidTopology{
+    {{{0, 1, 3}, false},
+     {{1, 2, 3}, false},
+     {{2, 0, 3}, false},
+     {{1, 0, 4}, false},
+     {{2, 1, 4}, false},
+     {{0, 2, 4}, false}},
+    false};
+static_assert(triangularBipyramidTopology.isValid(), "inconsistent topology of TriangularBipyramid");
+
+const ff::PolyhedralTopology& TriangularBipyramid::topology()
 {
-    return {{{{0, 1, 3}, false},
-             {{1, 2, 3}, false},
-             {{2, 0, 3}, false},
-             {{1, 0, 4}, false},
-             {{2, 1, 4}, false},
-             {{0, 2, 4}, false}},
-            false};
+    static const ff::PolyhedralTopology result = triangularBipyramidTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> TriangularBipyramid::vertices(const double edge)
@@ -42,23 +46,48 @@ std::vector<R3> TriangularBipyramid::vertices(const double edge)
     return {{-x, y, 0.}, {-x, -y, 0.}, {a, 0., 0.}, {0., 0., h}, {0., 0., -h}};
 }
 
-TriangularBipyramid::TriangularBipyramid(const double edge) : ff::Polyhedron(topology(), vertices(edge)) {}
+TriangularBipyramid::TriangularBipyramid(const double edge) : TriangularBipyramid(std::nothrow, edge)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+TriangularBipyramid::TriangularBipyramid(std::nothrow_t, const double edge)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices(edge))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices(1.)); // D_3h
+    setPointGroup(group);
+}
+
+void TriangularBipyramid::setParameters(const double edge)
+{
+    setShapeVertices(vertices(edge));
+}
+
+ff::Outcome TriangularBipyramid::trySetParameters(const double edge)
+{
+    return trySetShapeVertices(vertices(edge));
+}
 
 //  ************************************************************************************************
 //  Elongated Triangular Bipyramid (Triangular Bypramid with an added parameter for anisotropy)
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology ElongatedTriangularBipyramid::topology()
+constexpr StaticTopology<6, 3> elongatedTriangularBipyramidTopology{
+    {{{0, 1, 3}, false},
+     {{1, 2, 3}, false},
+     {{2, 0, 3}, false},
+     {{1, 0, 4}, false},
+     {{2, 1, 4}, false},
+     {{0, 2, 4}, false}},
+    false};
+static_assert(elongatedTriangularBipyramidTopology.isValid(), "inconsistent topology of ElongatedTriangularBipyramid");
 
+const ff::PolyhedralTopology& ElongatedTriangularBipyramid::topology()
 {
-    return {{{{0, 1, 3}, false},
-             {{1, 2, 3}, false},
-             {{2, 0, 3}, false},
-             {{1, 0, 4}, false},
-             {{2, 1, 4}, false},
-             {{0, 2, 4}, false}},
-            false};
+    static const ff::PolyhedralTopology result = elongatedTriangularBipyramidTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> ElongatedTriangularBipyramid::vertices2(const double edge, const double height)
@@ -71,24 +100,49 @@ std::vector<R3> ElongatedTriangularBipyramid::vertices2(const double edge, const
     return {{-x, y, 0.}, {-x, -y, 0.}, {a, 0., 0.}, {0., 0., h}, {0., 0., -h}};
 }
 
-ElongatedTriangularBipyramid::ElongatedTriangularBipyramid(const double edge, const double height) : ff::Polyhedron(topology(), vertices2(edge, height)) {}
+ElongatedTriangularBipyramid::ElongatedTriangularBipyramid(const double edge, const double height) : ElongatedTriangularBipyramid(std::nothrow, edge, height)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+ElongatedTriangularBipyramid::ElongatedTriangularBipyramid(std::nothrow_t, const double edge, const double height)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices2(edge, height))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices2(1., 2.)); // D_3h
+    setPointGroup(group);
+}
+
+void ElongatedTriangularBipyramid::setParameters(const double edge, const double height)
+{
+    setShapeVertices(vertices2(edge, height));
+}
+
+ff::Outcome ElongatedTriangularBipyramid::trySetParameters(const double edge, const double height)
+{
+    return trySetShapeVertices(vertices2(edge, height));
+}
 //  ************************************************************************************************
 //  Triangular Bifrustum (parameters are edges of base triangle, total theoritcal height of bipyramid, and height where truncature was operated as ratio of theoretical height)
 //  ************************************************************************************************
 
 
-ff::PolyhedralTopology TriangularBifrustum::topology()
+constexpr StaticTopology<8, 4> triangularBifrustumTopology{
+    {{{0, 1, 4, 3}, false},
+     {{1, 2, 5, 4}, false},
+     {{2, 0, 3, 5}, false},
+     {{1, 0, 6, 7}, false},
+     {{2, 1, 7, 8}, false},
+     {{0, 2, 8, 6}, false},
+     {{3, 4, 5}, false},
+     {{7, 6, 8}, false}},
+    false};
+static_assert(triangularBifrustumTopology.isValid(), "inconsistent topology of TriangularBifrustum");
 
+const ff::PolyhedralTopology& TriangularBifrustum::topology()
 {
-    return {{{{0, 1, 4, 3}, false},
-             {{1, 2, 5, 4}, false},
-             {{2, 0, 3, 5}, false},
-             {{1, 0, 6, 7}, false},
-             {{2, 1, 7, 8}, false},
-             {{0, 2, 8, 6}, false},
-             {{3, 4, 5}, false},
-             {{7, 6, 8}, false}},
-            false};
+    static const ff::PolyhedralTopology result = triangularBifrustumTopology.toTopology();
+    return result;
 }
 
 std::vector<R3> TriangularBifrustum::vertices3(const double edge, const double height, const double trunc)
@@ -104,6 +158,27 @@ std::vector<R3> TriangularBifrustum::vertices3(const double edge, const double h
             {-x*(1-z), y*(1-z), -z*h}, {-x*(1-z), -y*(1-z), -z*h}, {(1-z)*a, 0., -z*h}};//bottom plane
 }
 
-TriangularBifrustum::TriangularBifrustum(const double edge, const double height, const double trunc) : ff::Polyhedron(topology(), vertices3(edge, height, trunc)) {}
+TriangularBifrustum::TriangularBifrustum(const double edge, const double height, const double trunc) : TriangularBifrustum(std::nothrow, edge, height, trunc)
+{
+    if (!outcome().ok())
+        outcome().raise();
+}
+
+TriangularBifrustum::TriangularBifrustum(std::nothrow_t, const double edge, const double height, const double trunc)
+    : ff::Polyhedron(std::nothrow, &topology(), vertices3(edge, height, trunc))
+{
+    static const ff::PointGroup group = ff::PointGroup::ofVertices(vertices3(1., 1., .5)); // D_3h
+    setPointGroup(group);
+}
+
+void TriangularBifrustum::setParameters(const double edge, const double height, const double trunc)
+{
+    setShapeVertices(vertices3(edge, height, trunc));
+}
+
+ff::Outcome TriangularBifrustum::trySetParameters(const double edge, const double height, const double trunc)
+{
+    return trySetShapeVertices(vertices3(edge, height, trunc));
+}
 
 } // namespace ff::tri
@@ -18,22 +18,31 @@ namespace ff::tri {
 
 class TriangularBipyramid : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices(const double edge);
     TriangularBipyramid(const double edge);
+    TriangularBipyramid(std::nothrow_t, const double edge);
+    void setParameters(const double edge);
+    ff::Outcome trySetParameters(const double edge);
 };
 
 class ElongatedTriangularBipyramid : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices2(const double edge, const double height);
     ElongatedTriangularBipyramid(const double edge, const double height);
+    ElongatedTriangularBipyramid(std::nothrow_t, const double edge, const double height);
+    void setParameters(const double edge, const double height);
+    ff::Outcome trySetParameters(const double edge, const double height);
 };
 
 class TriangularBifrustum : public ff::Polyhedron {
 public:
-    static ff::PolyhedralTopology topology();
+    static const ff::PolyhedralTopology& topology();
     static std::vector<R3> vertices3(const double edge, const double height, const double trunc);
     TriangularBifrustum(const double edge, const double height, const double trunc);
+    TriangularBifrustum(std::nothrow_t, const double edge, const double height, const double trunc);
+    void setParameters(const double edge, const double height, const double trunc);
+    ff::Outcome trySetParameters(const double edge, const double height, const double trunc);
 };
 } // namespace ff::platonic
@@ -4,6 +4,7 @@
 
 namespace {
 constexpr auto ReciprocalFactorialArray = ff_aux::generateReciprocalFactorialArray<171>();
+constexpr auto ReciprocalFactorialProducts = ff_aux::generateReciprocalFactorialProductTable<22>();
 
 } // namespace
 
@@ -22,3 +23,12 @@ TEST_CASE("FactorialTest", "")
     */
     CHECK(ReciprocalFactorialArray[150] == Approx(1.75027620692601519e-263).epsilon(1e-15));
 }
+
+TEST_CASE("FactorialProductTest", "")
+{
+    for (size_t i = 0; i < 22; ++i)
+        for (size_t j = 0; j < 22; ++j)
+            CHECK(ReciprocalFactorialProducts[i][j]
+                  == ReciprocalFactorialArray[i] * ReciprocalFactorialArray[j]);
+    CHECK(ReciprocalFactorialProducts[3][2] == Approx(1.0 / 12));
+}
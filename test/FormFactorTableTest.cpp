@@ -0,0 +1,99 @@
+#include "catch.hpp"
+#include "ff/Cuboid.h"
+#include "ff/FormFactorTable.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/Platonic.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+//! Directions on a spiral that covers the sphere evenly.
+std::vector<R3> directions(size_t n)
+{
+    std::vector<R3> result;
+    for (size_t i = 0; i < n; ++i) {
+        const double z = 1 - (2 * i + 1.) / n;
+        const double rho = std::sqrt(1 - z * z);
+        const double phi = 2.399963229728653 * i; // golden angle
+        result.emplace_back(rho * std::cos(phi), rho * std::sin(phi), z);
+    }
+    return result;
+}
+
+} // namespace
+
+
+TEST_CASE("FormFactorTable:Interpolation", "")
+{
+    const double tolerance = 1e-3;
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    const std::vector<R3> u = directions(400);
+    for (const ff::Polyhedron* p : std::vector<const ff::Polyhedron*>{&dodeca, &pave}) {
+        const double q_max = 8 / p->radius();
+        const ff::FormFactorTable table(*p, q_max, tolerance);
+        CHECK(table.errorEstimate() <= tolerance);
+        CHECK(std::abs(table.formfactor(R3(0., 0., 0.)) - p->volume()) <= 1e-7 * p->volume());
+
+        // error relative to rms |F| at given |q|, including the first interval
+        for (double q : {0.01 * q_max, 0.1 * q_max, 0.37 * q_max, 0.81 * q_max, 0.999 * q_max}) {
+            std::vector<R3> qv;
+            for (const R3& ui : u)
+                qv.push_back(q * ui);
+            const std::vector<complex_t> F = table.formfactor(qv);
+            double max_diff = 0;
+            double sum2 = 0;
+            for (size_t i = 0; i < qv.size(); ++i) {
+                const complex_t f = p->formfactor(qv[i]);
+                max_diff = std::max(max_diff, std::abs(F[i] - f));
+                sum2 += std::norm(f);
+                CHECK(F[i] == table.formfactor(qv[i]));
+            }
+            CHECK(max_diff <= tolerance * std::sqrt(sum2 / qv.size()));
+        }
+
+        // beyond q_max, exact evaluation
+        const R3 q_out = 1.01 * q_max * u[7];
+        CHECK(table.formfactor(q_out) == p->formfactor(q_out));
+    }
+}
+
+TEST_CASE("FormFactorTable:OffCentre", "")
+{
+    // phases vary fastest through the origin, which tests the stencil of the first interval
+    std::vector<R3> V = ff::platonic::Tetrahedron::vertices(1.);
+    for (R3& v : V)
+        v += R3(0., 0., 1.5);
+    const ff::Polyhedron tetra(ff::platonic::Tetrahedron::topology(), V);
+    const double tolerance = 1e-3;
+    const ff::FormFactorTable table(tetra, 2 / tetra.radius(), tolerance);
+    CHECK(table.fallbackFraction() == 0);
+    for (const R3& u : directions(100)) {
+        const R3 q = 0.3 / tetra.radius() * u;
+        CHECK(std::abs(table.formfactor(q) - tetra.formfactor(q)) <= tolerance * tetra.volume());
+    }
+}
+
+TEST_CASE("FormFactorTable:Parallel", "")
+{
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const double q_max = 5 / dodeca.radius();
+    ff::ParallelEvaluator pe(3);
+    const ff::FormFactorTable T(dodeca, q_max, 1e-4, &pe);
+    const ff::FormFactorTable T0(dodeca, q_max, 1e-4);
+    CHECK(T.size() == T0.size());
+    CHECK(T.errorEstimate() == T0.errorEstimate());
+    for (const R3& u : directions(100)) {
+        const R3 q = 0.77 * q_max * u;
+        CHECK(T.formfactor(q) == T0.formfactor(q));
+    }
+}
+
+TEST_CASE("FormFactorTable:Invalid", "")
+{
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    CHECK_THROWS_AS(ff::FormFactorTable(dodeca, 0.), std::invalid_argument);
+    CHECK_THROWS_AS(ff::FormFactorTable(dodeca, 1., 0.), std::invalid_argument);
+}
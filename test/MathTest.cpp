@@ -0,0 +1,104 @@
+#include "ff/Math.h"
+#include "catch.hpp"
+#include <cfloat>
+#include <random>
+#include <vector>
+
+namespace {
+
+//! Arguments with real and imaginary parts over many orders of magnitude.
+std::vector<complex_t> testArguments()
+{
+    std::mt19937_64 gen(4711);
+    std::uniform_real_distribution<double> mantissa(-1., 1.);
+    std::uniform_int_distribution<int> exponent(-20, 6);
+    std::vector<complex_t> result{0., 1., -1., 1e-300, complex_t(0., 1e-8), complex_t(2., 700.)};
+    for (int i = 0; i < 3000; ++i) {
+        const double x = std::ldexp(mantissa(gen), exponent(gen));
+        const double y = std::ldexp(mantissa(gen), exponent(gen) - 1);
+        result.push_back(complex_t(x, i % 3 ? y : 0.));
+    }
+    return result;
+}
+
+//! Relative deviation of one component in units of DBL_EPSILON.
+double ulps(double value, long double exact)
+{
+    if (exact == 0)
+        return value == 0 ? 0 : INFINITY;
+    return static_cast<double>(std::abs((value - exact) / exact) / DBL_EPSILON);
+}
+
+double ulps(complex_t value, long double re, long double im)
+{
+    return std::max(ulps(value.real(), re), ulps(value.imag(), im));
+}
+
+struct Exact {
+    long double sin_re, sin_im, cos_re, cos_im, exp_re, exp_im;
+};
+
+Exact exact(complex_t z)
+{
+    const long double x = z.real();
+    const long double y = z.imag();
+    const long double e = std::exp(-y);
+    return {std::sin(x) * std::cosh(y),  std::cos(x) * std::sinh(y), std::cos(x) * std::cosh(y),
+            -std::sin(x) * std::sinh(y), e * std::cos(x),             e * std::sin(x)};
+}
+
+//! Deviation of sinc, relative to |sinc|, in units of DBL_EPSILON.
+double sincUlps(complex_t value, complex_t z)
+{
+    if (z == complex_t(0., 0.))
+        return value == 1. ? 0 : INFINITY;
+    const Exact ex = exact(z);
+    const std::complex<long double> s(ex.sin_re, ex.sin_im);
+    const std::complex<long double> sinc = s / std::complex<long double>(z);
+    const std::complex<long double> d(value.real() - sinc.real(), value.imag() - sinc.imag());
+    return static_cast<double>(std::abs(d) / std::abs(sinc) / DBL_EPSILON);
+}
+
+} // namespace
+
+
+TEST_CASE("Math:Scalar", "")
+{
+    double worst_sincos = 0, worst_exp = 0, worst_sinc = 0;
+    for (const complex_t z : testArguments()) {
+        const Exact ex = exact(z);
+        complex_t s, c;
+        ff_aux::sincos(z, s, c);
+        worst_sincos = std::max(worst_sincos, ulps(s, ex.sin_re, ex.sin_im));
+        worst_sincos = std::max(worst_sincos, ulps(c, ex.cos_re, ex.cos_im));
+        CHECK(ff_aux::sin(z) == s);
+        CHECK(ff_aux::cos(z) == c);
+        worst_exp = std::max(worst_exp, ulps(ff_aux::exp_I(z), ex.exp_re, ex.exp_im));
+        worst_sinc = std::max(worst_sinc, sincUlps(ff_aux::sinc(z), z));
+    }
+    CHECK(worst_sincos <= 4);
+    CHECK(worst_exp <= 4);
+    CHECK(worst_sinc <= 6);
+}
+
+TEST_CASE("Math:Batch", "")
+{
+    const std::vector<complex_t> z = testArguments();
+    const size_t n = z.size();
+    std::vector<complex_t> s(n), c(n), e(n), sc(n);
+    ff_aux::sincos(z.data(), s.data(), c.data(), n);
+    ff_aux::exp_I(z.data(), e.data(), n);
+    ff_aux::sinc(z.data(), sc.data(), n);
+
+    double worst_sincos = 0, worst_exp = 0, worst_sinc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Exact ex = exact(z[i]);
+        worst_sincos = std::max(worst_sincos, ulps(s[i], ex.sin_re, ex.sin_im));
+        worst_sincos = std::max(worst_sincos, ulps(c[i], ex.cos_re, ex.cos_im));
+        worst_exp = std::max(worst_exp, ulps(e[i], ex.exp_re, ex.exp_im));
+        worst_sinc = std::max(worst_sinc, sincUlps(sc[i], z[i]));
+    }
+    CHECK(worst_sincos <= 4.5);
+    CHECK(worst_exp <= 4.5);
+    CHECK(worst_sinc <= 6.5);
+}
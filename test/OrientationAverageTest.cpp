@@ -0,0 +1,92 @@
+#include "catch.hpp"
+#include "ff/Cuboid.h"
+#include "ff/OrientationAverage.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/Platonic.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+double sinc(double x)
+{
+    return x == 0 ? 1. : std::sin(x) / x;
+}
+
+//! Reference averages for a centered pave, F = V sinc(qx a/2) sinc(qy b/2) sinc(qz c/2),
+//! from midpoint rule in cos(theta) and phi on a fine grid.
+void paveReference(double a, double b, double c, double q, double& I, double& A)
+{
+    const size_t nx = 2000;
+    const size_t nphi = 2000;
+    I = 0;
+    A = 0;
+    for (size_t i = 0; i < nx; ++i) {
+        const double x = (i + .5) / nx; // upper hemisphere suffices
+        const double s = std::sqrt(1 - x * x);
+        for (size_t j = 0; j < nphi; ++j) {
+            const double phi = 2 * pi * (j + .5) / nphi;
+            const double F = a * b * c * sinc(q * s * std::cos(phi) * a / 2)
+                             * sinc(q * s * std::sin(phi) * b / 2) * sinc(q * x * c / 2);
+            I += F * F;
+            A += F;
+        }
+    }
+    I /= nx * nphi;
+    A /= nx * nphi;
+}
+
+} // namespace
+
+
+TEST_CASE("OrientationAverage:Pave", "")
+{
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    const ff::OrientationAverager avg(1e-9);
+    for (double q : {0.3, 2., 10.}) {
+        const ff::OrientationAverage r = avg.average(pave, q);
+        double I, A;
+        paveReference(1., 2., 3., q, I, A);
+        CHECK(std::abs(r.intensity - I) <= 1e-5 * I);
+        CHECK(std::abs(r.amplitude - A) <= 1e-5 * std::abs(A) + 1e-7 * pave.volume());
+        CHECK(r.error <= 1e-9 * r.intensity);
+    }
+    const ff::OrientationAverage r0 = avg.average(pave, 0.);
+    CHECK(r0.intensity == pave.volume() * pave.volume());
+    CHECK(r0.amplitude == pave.volume());
+}
+
+TEST_CASE("OrientationAverage:Parallel", "")
+{
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    const ff::OrientationAverager avg(1e-8);
+    const std::vector<double> q{0., 1e-3, 0.5, 1., 3., 7., 20.};
+    ff::ParallelEvaluator pe(3);
+    const std::vector<ff::OrientationAverage> R = avg.average(pave, q, &pe);
+    const std::vector<ff::OrientationAverage> R0 = avg.average(pave, q);
+    for (size_t i = 0; i < q.size(); ++i) {
+        CHECK(R[i].intensity == R0[i].intensity);
+        CHECK(R[i].amplitude == R0[i].amplitude);
+        CHECK(R[i].nDirections == R0[i].nDirections);
+    }
+}
+
+TEST_CASE("OrientationAverage:Symmetric", "")
+{
+    // the dodecahedron is integrated over its fundamental triangle, the plain polyhedron
+    // with the same vertices over the hemisphere
+    const ff::platonic::Dodecahedron dodeca(1.);
+    const ff::Polyhedron plain(ff::platonic::Dodecahedron::topology(),
+                               ff::platonic::Dodecahedron::vertices(1.));
+    const ff::OrientationAverager avg(1e-8);
+    for (double q : {0.3, 3., 30.}) {
+        const ff::OrientationAverage r = avg.average(dodeca, q);
+        const ff::OrientationAverage r0 = avg.average(plain, q);
+        CHECK(std::abs(r.intensity - r0.intensity) <= 1e-8 * r0.intensity);
+        CHECK(std::abs(r.amplitude - r0.amplitude) <= 1e-8 * r0.intensity / dodeca.volume());
+        CHECK(r.nDirections <= r0.nDirections);
+    }
+    CHECK(avg.average(dodeca, 30.).nDirections * 5 < avg.average(plain, 30.).nDirections);
+}
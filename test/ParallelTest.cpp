@@ -0,0 +1,141 @@
+#include "catch.hpp"
+#include "ff/Diagnostics.h"
+#include "ff/ParallelEvaluator.h"
+#include "ff/Platonic.h"
+#include "ff/Prism.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+//! Wavevectors along a ray, from the series into the analytic regime, half of them complex.
+std::vector<C3> testWavevectors(size_t n)
+{
+    std::vector<C3> result;
+    const R3 u = R3(0.3, -0.5, 0.8).unit();
+    for (size_t i = 0; i < n; ++i) {
+        const double q = 1e-5 * pow(1e7, i / (n - 1.));
+        const double qi = i & 1 ? 1e-3 * q : 0;
+        result.push_back(C3(complex_t(u.x() * q, qi), u.y() * q, u.z() * q));
+    }
+    return result;
+}
+
+} // namespace
+
+
+TEST_CASE("ParallelEvaluator:Polyhedron", "")
+{
+    const std::vector<C3> q = testWavevectors(1000);
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    for (size_t n_threads : {1, 3, 8}) {
+        ff::ParallelEvaluator pe(n_threads, 7);
+        CHECK(pe.nThreads() == n_threads);
+        std::vector<complex_t> F(q.size());
+        CHECK(pe.formfactor(dodeca, q.data(), F.data(), q.size()));
+        // each chunk is evaluated by the serial batch code, hence identical results
+        const std::vector<complex_t> F0 = dodeca.formfactor(q);
+        for (size_t i = 0; i < q.size(); ++i)
+            CHECK(F[i] == F0[i]);
+        CHECK(pe.formfactor(prism, q.data(), F.data(), q.size()));
+        const std::vector<complex_t> G0 = prism.formfactor(q);
+        for (size_t i = 0; i < q.size(); ++i)
+            CHECK(F[i] == G0[i]);
+    }
+}
+
+TEST_CASE("ParallelEvaluator:Grid", "")
+{
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    std::vector<C3> qxy;
+    for (const C3& qi : testWavevectors(100))
+        qxy.push_back(C3(qi.x(), qi.y(), 0.));
+    const std::vector<complex_t> qz{0., -.3, 2., complex_t(4., .5)};
+    const std::vector<complex_t> F0 = prism.formfactor_grid(qxy, qz);
+    ff::ParallelEvaluator pe(3, 7);
+    std::vector<complex_t> F(F0.size());
+    CHECK(pe.formfactor_grid(prism, qxy.data(), qxy.size(), qz.data(), qz.size(), F.data()));
+    for (size_t i = 0; i < F.size(); ++i)
+        CHECK(F[i] == F0[i]);
+}
+
+TEST_CASE("ParallelEvaluator:Intensity", "")
+{
+    const std::vector<C3> q = testWavevectors(1000);
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    ff::IntensityParameters par;
+    par.contrast = 3.;
+    par.background = 1.;
+    std::vector<double> I0(q.size());
+    ff::intensity(dodeca, q.data(), I0.data(), q.size(), par);
+    ff::ParallelEvaluator pe(3, 7);
+    std::vector<double> I(q.size());
+    std::vector<float> If(q.size());
+    CHECK(pe.intensity(dodeca, q.data(), I.data(), q.size(), par));
+    CHECK(pe.intensity(dodeca, q.data(), If.data(), q.size(), par));
+    for (size_t i = 0; i < q.size(); ++i) {
+        CHECK(I[i] == I0[i]);
+        CHECK(If[i] == static_cast<float>(I0[i]));
+    }
+}
+
+TEST_CASE("ParallelEvaluator:Diagnostics", "")
+{
+    const std::vector<C3> q = testWavevectors(1000);
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    ff::Diagnostics serial;
+    {
+        ff::DiagnosticsScope scope(serial);
+        dodeca.formfactor(q);
+    }
+    ff::ParallelEvaluator pe(3, 7);
+    ff::Diagnostics parallel;
+    std::vector<complex_t> F(q.size());
+    {
+        ff::DiagnosticsScope scope(parallel);
+        CHECK(pe.formfactor(dodeca, q.data(), F.data(), q.size()));
+    }
+    // evaluations on all threads are recorded in the sink of the caller
+    CHECK(parallel.evaluations() == q.size());
+    CHECK(parallel.regime == serial.regime);
+    CHECK(parallel.expandedFaces == serial.expandedFaces);
+}
+
+TEST_CASE("ParallelEvaluator:Cancel", "")
+{
+    ff::ParallelEvaluator pe(4, 1);
+    std::atomic<size_t> count{0};
+    CHECK(!pe.run(
+        [&](size_t, size_t) {
+            if (++count == 10)
+                pe.cancel();
+        },
+        10000));
+    CHECK(count < 10000);
+    // the cancel request is cleared when run returns
+    count = 0;
+    CHECK(pe.run([&](size_t i0, size_t i1) { count += i1 - i0; }, 10000));
+    CHECK(count == 10000);
+    // a request that comes after the last chunk has started is kept for the next batch
+    CHECK(pe.run([&](size_t, size_t) { pe.cancel(); }, 1));
+    count = 0;
+    CHECK(!pe.run([&](size_t i0, size_t i1) { count += i1 - i0; }, 10000));
+    CHECK(count == 0);
+    CHECK(pe.run([&](size_t i0, size_t i1) { count += i1 - i0; }, 10000));
+    CHECK(count == 10000);
+}
+
+TEST_CASE("ParallelEvaluator:Exception", "")
+{
+    ff::ParallelEvaluator pe(4, 1);
+    CHECK_THROWS_AS(pe.run(
+                        [](size_t i0, size_t) {
+                            if (i0 == 500)
+                                throw std::runtime_error("test");
+                        },
+                        1000),
+                    std::runtime_error);
+    CHECK(pe.run([](size_t, size_t) {}, 1000));
+}
@@ -0,0 +1,111 @@
+#include "catch.hpp"
+#include "ff/Cuboid.h"
+#include "ff/Penta.h"
+#include "ff/Platonic.h"
+#include "ff/SymmetricGrid.h"
+#include "ff/Tri.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("PointGroup:Shapes", "")
+{
+    const ff::platonic::Tetrahedron tetra(1.);
+    const ff::platonic::Octahedron octa(1.);
+    const ff::platonic::Dodecahedron dodeca(1.);
+    const ff::platonic::Icosahedron icosa(1.);
+    const ff::cuboid::Cube cube(1.);
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    const ff::penta::Decahedron deca(1.);
+    const ff::penta::CappedPentagonalPrism capped(1., 2., .5);
+    const ff::tri::TriangularBifrustum tribi(1., 1., .5);
+    const std::vector<std::pair<const ff::Polyhedron*, size_t>> shapes{
+        {&tetra, 24}, {&octa, 48},  {&dodeca, 120},  {&icosa, 120}, {&cube, 48},
+        {&pave, 8},   {&deca, 20}, {&capped, 20}, {&tribi, 12}};
+
+    const std::vector<R3> q{{0.3, -1.1, 2.3}, {4.1, 0.7, -0.2}, {0.01, 0.02, 0.03}};
+    for (const auto& [p, order] : shapes) {
+        const ff::PointGroup& G = p->pointGroup();
+        CHECK(G.order() == order);
+        std::array<R3, 3> corners;
+        CHECK(G.fundamentalTriangle(corners));
+        for (const ff::PointGroup::Matrix& g : G.elements())
+            for (const R3& qi : q) {
+                const complex_t f = p->formfactor(qi);
+                CHECK(std::abs(p->formfactor(ff::PointGroup::apply(g, qi)) - f)
+                      <= 1e-11 * p->volume());
+                CHECK(std::abs(p->formfactor(-1. * ff::PointGroup::apply(g, qi)) - std::conj(f))
+                      <= 1e-11 * p->volume());
+            }
+    }
+    CHECK(!tetra.pointGroup().hasInversion());
+    CHECK(octa.pointGroup().hasInversion());
+    CHECK(cube.pointGroup().includes(pave.pointGroup()));
+    CHECK(!pave.pointGroup().includes(cube.pointGroup()));
+
+    // without shape class, only inversion symmetry is known from the topology
+    const ff::Polyhedron plain(ff::platonic::Octahedron::topology(),
+                               ff::platonic::Octahedron::vertices(1.));
+    CHECK(plain.pointGroup().order() == 2);
+    CHECK(plain.pointGroup().hasInversion());
+    std::array<R3, 3> corners;
+    CHECK(!plain.pointGroup().fundamentalTriangle(corners));
+
+    // setParameters keeps the group of the shape class, setVertices falls back to the topology
+    ff::cuboid::Pave moved(1., 2., 3.);
+    moved.setParameters(2., 3., 4.);
+    CHECK(moved.pointGroup().order() == 8);
+    moved.setVertices(ff::cuboid::Pave::vertices3(2., 3., 4.));
+    CHECK(moved.pointGroup().order() == 1);
+    moved.setParameters(2., 3., 4.);
+    CHECK(moved.pointGroup().order() == 8);
+    ff::platonic::Dodecahedron dodecaMoved(1.);
+    CHECK(dodecaMoved.trySetVertices(ff::platonic::Dodecahedron::vertices(2.)).ok());
+    CHECK(dodecaMoved.pointGroup().order() == 2);
+    CHECK(dodecaMoved.trySetParameters(1.).ok());
+    CHECK(dodecaMoved.pointGroup().order() == 120);
+}
+
+TEST_CASE("PointGroup:Grid", "")
+{
+    std::vector<R3> q;
+    const int n = 12;
+    for (int i = -n; i <= n; ++i)
+        for (int j = -n; j <= n; ++j)
+            for (int k = -n; k <= n; ++k)
+                q.emplace_back(0.4 * i, 0.4 * j, 0.4 * k);
+    std::vector<C3> qc;
+    for (const R3& qi : q)
+        qc.emplace_back(qi.x(), qi.y(), qi.z());
+
+    // the cubic grid has the symmetry of the cube, and of the pave
+    const ff::cuboid::Cube cube(1.);
+    const ff::SymmetricGrid grid(cube.pointGroup(), q);
+    CHECK(grid.size() == q.size());
+    CHECK(grid.nUnique() * 30 < grid.size());
+    ff::cuboid::Pave pave(1., 2., 3.);
+    const ff::SymmetricGrid paveGrid(pave.pointGroup(), q);
+    CHECK(paveGrid.nUnique() * 7 < paveGrid.size());
+    for (const ff::Polyhedron* p : std::vector<const ff::Polyhedron*>{&cube, &pave}) {
+        const ff::SymmetricGrid& g = p == &cube ? grid : paveGrid;
+        const std::vector<complex_t> F = g.formfactor(*p);
+        const std::vector<complex_t> F0 = p->formfactor(qc);
+        for (size_t i = 0; i < q.size(); ++i)
+            CHECK(std::abs(F[i] - F0[i]) <= 1e-11 * p->volume());
+    }
+
+    // reusable after a change of parameters
+    pave.setParameters(2., 1.5, .7);
+    const std::vector<complex_t> F = paveGrid.formfactor(pave);
+    for (size_t i = 0; i < q.size(); i += 13)
+        CHECK(std::abs(F[i] - pave.formfactor(q[i])) <= 1e-11 * pave.volume());
+    CHECK_THROWS_AS(grid.formfactor(pave), std::invalid_argument);
+
+    // of the icosahedral group, only a subgroup maps the cubic grid onto itself
+    const ff::platonic::Dodecahedron dodeca(1.);
+    const ff::SymmetricGrid dodecaGrid(dodeca.pointGroup(), q);
+    CHECK(dodecaGrid.nUnique() * 2 < dodecaGrid.size());
+    const std::vector<complex_t> G = dodecaGrid.formfactor(dodeca);
+    for (size_t i = 0; i < q.size(); ++i)
+        CHECK(std::abs(G[i] - dodeca.formfactor(q[i])) <= 1e-11 * dodeca.volume());
+}
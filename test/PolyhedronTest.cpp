@@ -0,0 +1,609 @@
+#include "catch.hpp"
+#include "ff/Cuboid.h"
+#include "ff/Diagnostics.h"
+#include "ff/Intensity.h"
+#include "ff/Math.h"
+#include "ff/Penta.h"
+#include "ff/Platonic.h"
+#include "ff/PolyhedralSimd.h"
+#include "ff/Prism.h"
+#include "ff/Status.h"
+#include "ff/TransformedPolyhedron.h"
+#include "ff/Tri.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+//! Wavevectors that cover all evaluation regimes: zero, series, analytic, complex.
+std::vector<C3> testWavevectors()
+{
+    std::vector<C3> result{{0., 0., 0.}, {0., 0., 3.}, {1e-5, 0., 3.}, {1., 1., 0.}};
+    const R3 u = R3(0.3, -0.5, 0.8).unit();
+    for (int i = 0; i < 60; ++i) {
+        const double q = 1e-9 * pow(1e11, i / 59.);
+        result.push_back(C3(u.x() * q, u.y() * q, u.z() * q));
+        result.push_back(C3(complex_t(u.x() * q, 1e-3 * q), u.y() * q, u.z() * q));
+    }
+    return result;
+}
+
+//! Compares dF/dq and dF/dp from Polyhedron::formfactor_gradient with central differences.
+template <class S, class... P>
+void checkGradient(std::vector<R3> (*vertices)(P...), P... parameters)
+{
+    const std::array<double, sizeof...(P)> p{parameters...};
+    const S shape(parameters...);
+    const auto J = ff::vertexJacobian(vertices, parameters...);
+    std::vector<C3> dFdv(shape.nVertices());
+    std::vector<complex_t> dFdp(p.size());
+    std::vector<C3> q{{0., 0., 0.}, {1e-4, 2e-4, -1e-4}, {0., 0., 3.}, {.7, 0., 0.}};
+    const R3 u = R3(0.3, -0.5, 0.8).unit();
+    for (double t : {.1, 1., 4., 20.}) {
+        q.push_back(C3(u.x() * t, u.y() * t, u.z() * t));
+        q.push_back(C3(complex_t(u.x() * t, .2), u.y() * t, u.z() * t));
+    }
+    for (const C3& qi : q) {
+        C3 dFdq;
+        const complex_t F = shape.formfactor_gradient(qi, &dFdq, dFdv.data());
+        CHECK(F == shape.formfactor(qi));
+        const double scale = shape.volume() * shape.radius();
+        const double h = 1e-5 / shape.radius();
+        for (int k = 0; k < 3; ++k) {
+            C3 dq;
+            dq[k] = h;
+            const complex_t fd =
+                (shape.formfactor(qi + dq) - shape.formfactor(qi - dq)) / (2 * h);
+            CHECK(std::abs(dFdq[k] - fd) <= 1e-7 * scale);
+        }
+        ff::Polyhedron::chain(dFdv.data(), J, dFdp.data());
+        for (size_t k = 0; k < p.size(); ++k) {
+            const double hp = 1e-6 * std::max(p[k], 1.);
+            auto pp = p;
+            auto pm = p;
+            pp[k] += hp;
+            pm[k] -= hp;
+            const complex_t fd = (std::make_from_tuple<S>(pp).formfactor(qi)
+                                  - std::make_from_tuple<S>(pm).formfactor(qi))
+                                 / (2 * hp);
+            CHECK(std::abs(dFdp[k] - fd) <= 1e-7 * scale / p[k]);
+        }
+    }
+}
+
+} // namespace
+
+
+TEST_CASE("Polyhedron:Batch", "")
+{
+    const std::vector<C3> q = testWavevectors();
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    for (const ff::Polyhedron* p : std::vector<const ff::Polyhedron*>{&dodeca, &pave}) {
+        const std::vector<complex_t> F = p->formfactor(q);
+        for (size_t i = 0; i < q.size(); ++i) {
+            // real q is evaluated by the SIMD kernel, which may differ in the last bits
+            const complex_t f = p->formfactor(q[i]);
+            if (q[i].x().imag() == 0 && q[i].y().imag() == 0 && q[i].z().imag() == 0)
+                CHECK(std::abs(F[i] - f) <= 1e-11 * p->volume());
+            else
+                CHECK(F[i] == f);
+        }
+    }
+}
+
+TEST_CASE("Polyhedron:Lockstep", "")
+{
+    // Batch evaluation uses the lockstep kernels only if the library is compiled for a SIMD
+    // instruction set. Here they are called directly, so that they are also tested with the
+    // portable packs.
+    const ff::Accuracy acc = ff::Accuracy::forTolerance(1e-3, ff::Precision::Mixed);
+    const auto check = [&acc](const ff::Polyhedron& p, const ff::PolyhedralTopology& topology,
+                              const std::vector<R3>& vertices) {
+        std::vector<ff::PolyhedralFace> faces;
+        for (const ff::PolygonalTopology& tf : topology.faces) {
+            std::vector<R3> corners;
+            for (int i : tf.vertexIndices)
+                corners.push_back(vertices[i]);
+            faces.emplace_back(corners, tf.symmetry_S2);
+        }
+        const ff::PolyhedralArrays arrays(faces); // all faces, without use of symmetry Ci
+        for (bool single : {false, true}) {
+            const double t_min = single ? acc.q_min_single : 2.;
+            const double t_max = single ? acc.q_max_single : 20.;
+            std::vector<R3> q;
+            for (int i = 0; i < 101; ++i) {
+                const double t = i / 100.;
+                const R3 u(std::cos(7 * t), std::sin(7 * t), 2 * t - 1);
+                q.push_back(u.unit() * ((t_min + t * (t_max - t_min)) / p.radius()));
+            }
+            const size_t W = single ? ff::simd::lanes_single() : ff::simd::lanes();
+            std::vector<double> qx(W), qy(W), qz(W);
+            std::vector<complex_t> sum(W);
+            for (size_t j0 = 0; j0 < q.size(); j0 += W) {
+                const size_t n = std::min(W, q.size() - j0);
+                for (size_t l = 0; l < W; ++l) {
+                    const R3& ql = q[j0 + std::min(l, n - 1)];
+                    qx[l] = ql.x();
+                    qy[l] = ql.y();
+                    qz[l] = ql.z();
+                }
+                if (single)
+                    ff::simd::analytic_sum_single(arrays, false, acc, n, qx.data(), qy.data(),
+                                                  qz.data(), sum.data(), nullptr, nullptr);
+                else
+                    ff::simd::analytic_sum(arrays, false, ff::Accuracy(), n, qx.data(),
+                                           qy.data(), qz.data(), sum.data(), nullptr, nullptr);
+                for (size_t l = 0; l < n; ++l) {
+                    const R3& ql = q[j0 + l];
+                    const complex_t f0 = p.formfactor(ql);
+                    const double tolerance = single ? 1e-3 * std::abs(f0) : 0.;
+                    CHECK(std::abs(sum[l] / I / ql.mag2() - f0)
+                          <= tolerance + 1e-11 * p.volume());
+                }
+            }
+        }
+    };
+    check(ff::platonic::Dodecahedron(0.9), ff::platonic::Dodecahedron::topology(),
+          ff::platonic::Dodecahedron::vertices(0.9));
+    check(ff::platonic::Tetrahedron(1.3), ff::platonic::Tetrahedron::topology(),
+          ff::platonic::Tetrahedron::vertices(1.3));
+}
+
+TEST_CASE("Prism:Batch", "")
+{
+    const std::vector<C3> q = testWavevectors();
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    const std::vector<complex_t> F = prism.formfactor(q);
+    for (size_t i = 0; i < q.size(); ++i) {
+        // the batched sinc uses the SIMD sincos, which may differ in the last bit
+        const complex_t f = prism.formfactor(q[i]);
+        CHECK(std::abs(F[i] - f) <= 1e-14 * std::abs(f));
+    }
+}
+
+TEST_CASE("Prism:Grid", "")
+{
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    const std::vector<C3> qxy{{0., 0., 0.}, {1e-5, 2e-5, 7.}, {.3, -1.2, 0.}, {4., 3., 0.},
+                              {complex_t(2., .1), -1., 0.}};
+    const std::vector<complex_t> qz{0., 1e-6, -.7, 5., complex_t(2., -.3)};
+    std::vector<C3> q;
+    for (const C3& qi : qxy)
+        for (const complex_t& qzj : qz)
+            q.push_back(C3(qi.x(), qi.y(), qzj));
+    ff::Diagnostics diag0;
+    std::vector<complex_t> F0;
+    {
+        ff::DiagnosticsScope scope(diag0);
+        F0 = prism.formfactor(q);
+    }
+
+    ff::Diagnostics diag;
+    std::vector<complex_t> F;
+    {
+        ff::DiagnosticsScope scope(diag);
+        F = prism.formfactor_grid(qxy, qz);
+    }
+    CHECK(diag.regime[ff::Diagnostics::Prism] == q.size());
+    CHECK(diag.expansions > 0); // qxy = (1e-5, 2e-5) is almost normal to the base
+    size_t expanded = 0;
+    for (size_t k = 0; k < diag.expandedFaces.size(); ++k)
+        expanded += k * diag.expandedFaces[k];
+    CHECK(expanded == diag.expansions);
+    CHECK(diag.expandedFaces == diag0.expandedFaces);
+    CHECK(diag.expansionOrder == diag0.expansionOrder);
+    REQUIRE(F.size() == q.size());
+    for (size_t i = 0; i < q.size(); ++i)
+        CHECK(std::abs(F[i] - F0[i]) <= 1e-15 * std::abs(F0[i]));
+}
+
+TEST_CASE("Polyhedron:Diagnostics", "")
+{
+    const std::vector<C3> q = testWavevectors();
+    const ff::platonic::Dodecahedron dodeca(0.9);
+
+    ff::Diagnostics pointwise;
+    {
+        ff::DiagnosticsScope scope(pointwise);
+        for (const C3& qi : q)
+            dodeca.formfactor(qi);
+    }
+    CHECK(pointwise.evaluations() == q.size());
+    CHECK(pointwise.regime[ff::Diagnostics::Zero] == 1);
+    CHECK(pointwise.regime[ff::Diagnostics::Series] > 0);
+    CHECK(pointwise.regime[ff::Diagnostics::Analytic] > 0);
+    CHECK(pointwise.expansions > 0); // q = (1e-5, 0, 3) is almost normal to two faces
+    size_t expanded = 0;
+    for (size_t k = 0; k < pointwise.expandedFaces.size(); ++k)
+        expanded += k * pointwise.expandedFaces[k];
+    CHECK(expanded == pointwise.expansions);
+
+    // the batch evaluation takes the same branches
+    ff::Diagnostics batch;
+    {
+        ff::DiagnosticsScope scope(batch);
+        dodeca.formfactor(q);
+    }
+    CHECK(batch.regime == pointwise.regime);
+    CHECK(batch.seriesOrder == pointwise.seriesOrder);
+    CHECK(batch.expandedFaces == pointwise.expandedFaces);
+    CHECK(batch.expansionOrder == pointwise.expansionOrder);
+
+    // nothing is recorded outside of a scope
+    dodeca.formfactor(q);
+    CHECK(batch.evaluations() == q.size());
+    batch += pointwise;
+    CHECK(batch.evaluations() == 2 * q.size());
+    batch.clear();
+    CHECK(batch.evaluations() == 0);
+
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    {
+        ff::DiagnosticsScope scope(batch);
+        prism.formfactor(q);
+    }
+    CHECK(batch.regime[ff::Diagnostics::Prism] == q.size());
+}
+
+TEST_CASE("Polyhedron:RealQ", "")
+{
+    // A negligible imaginary part forces the complex code path, which must agree with the
+    // real one up to rounding.
+    const std::vector<C3> q = testWavevectors();
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    for (const C3& qc : q) {
+        if (qc.x().imag() != 0)
+            continue;
+        const R3 qr = qc.real();
+        const C3 qi(complex_t(qr.x(), 1e-200), qr.y(), qr.z());
+        const complex_t f = dodeca.formfactor(qr);
+        CHECK(f == dodeca.formfactor(qc));
+        CHECK(std::abs(f - dodeca.formfactor(qi)) <= 1e-11 * dodeca.volume());
+        const complex_t g = prism.formfactor(qr);
+        CHECK(g == prism.formfactor(qc));
+        CHECK(std::abs(g - prism.formfactor(qi)) <= 1e-13 * std::abs(g));
+    }
+}
+
+TEST_CASE("Polyhedron:Ray", "")
+{
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::cuboid::Pave pave(1., 2., 3.);
+    for (const ff::Polyhedron* p : std::vector<const ff::Polyhedron*>{&dodeca, &pave}) {
+        for (const R3& u : {R3(0.3, -0.5, 0.8), R3(0., 0., 1.), R3(1., 1., 0.)}) {
+            // from the series regime far into the analytic regime, across q=0
+            const double t0 = -0.5;
+            const double dt = 1e-3;
+            const size_t n = 100000;
+            const std::vector<complex_t> F = p->formfactor_ray(u, t0, dt, n);
+            for (size_t j = 0; j < n; j += 7) {
+                const complex_t f = p->formfactor((t0 + j * dt) * u);
+                CHECK(std::abs(F[j] - f) <= 1e-11 * p->volume());
+            }
+        }
+    }
+}
+
+TEST_CASE("Polyhedron:Transformed", "")
+{
+    const auto cube = std::make_shared<const ff::cuboid::Cube>(1.);
+    const std::vector<C3> q = testWavevectors();
+
+    // scaled and translated cube, vs. pave with translated vertices
+    const R3 t(0.3, 0.1, -0.2);
+    const ff::AffineMap m = ff::AffineMap::translation(t) * ff::AffineMap::scaling(1., 2., 3.);
+    const ff::TransformedPolyhedron view(cube, m);
+    ff::PolyhedralTopology topology = ff::cuboid::Pave::topology();
+    for (ff::PolygonalTopology& f : topology.faces)
+        f.symmetry_S2 = false; // not invariant under translation
+    std::vector<R3> vertices = ff::cuboid::Pave::vertices3(1., 2., 3.);
+    for (R3& v : vertices)
+        v += t;
+    const ff::Polyhedron moved(topology, vertices);
+    CHECK(std::abs(view.volume() - 6.) < 1e-14);
+    const std::vector<complex_t> F = view.formfactor(q);
+    for (size_t i = 0; i < q.size(); ++i)
+        CHECK(std::abs(F[i] - moved.formfactor(q[i])) <= 1e-11 * moved.volume());
+
+    // rotation by 90 degrees around z swaps the a and b edges
+    const auto pave = std::make_shared<const ff::cuboid::Pave>(1., 2., 3.);
+    const ff::cuboid::Pave swapped(2., 1., 3.);
+    const ff::AffineMap rot = ff::AffineMap::rotation(R3(0, 0, 1), 3.14159265358979323846 / 2);
+    const ff::TransformedPolyhedron rotated(pave, rot);
+    for (const C3& qi : q)
+        CHECK(std::abs(rotated.formfactor(qi) - swapped.formfactor(qi)) <= 1e-11 * 6.);
+
+    // ensemble of sizes at one q
+    const std::vector<ff::AffineMap> maps{ff::AffineMap::scaling(0.5), ff::AffineMap::scaling(2.),
+                                          rot};
+    const C3 q0(1., 2., 0.5);
+    std::vector<complex_t> G(maps.size());
+    ff::TransformedPolyhedron::formfactor_ensemble(*pave, maps.data(), maps.size(), q0, G.data());
+    for (size_t i = 0; i < maps.size(); ++i)
+        CHECK(std::abs(G[i] - ff::TransformedPolyhedron(pave, maps[i]).formfactor(q0))
+              <= 1e-11 * maps[i].determinant() * 6.);
+}
+
+TEST_CASE("Polyhedron:Moments", "")
+{
+    // pave with edges a, b, c: I_xx = V (b^2+c^2)/12 etc.
+    ff::cuboid::Pave pave(1., 2., 3.);
+    CHECK(std::abs(pave.centroid().mag()) < 1e-15);
+    CHECK(pave.radiusOfGyration() == Approx(std::sqrt(14. / 12)).epsilon(1e-14));
+    const std::array<R3, 3> I = pave.inertiaTensor();
+    CHECK(I[0].x() == Approx(6. * 13 / 12).epsilon(1e-14));
+    CHECK(I[1].y() == Approx(6. * 10 / 12).epsilon(1e-14));
+    CHECK(I[2].z() == Approx(6. * 5 / 12).epsilon(1e-14));
+    CHECK(std::abs(I[0].y()) + std::abs(I[0].z()) + std::abs(I[1].z()) < 1e-14);
+
+    // moments are recomputed in setVertices
+    pave.setParameters(2., 2., 2.);
+    CHECK(pave.radiusOfGyration() == Approx(1.).epsilon(1e-14));
+
+    // symmetry Ci: isotropic inertia tensor, trace 2 V Rg^2
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const std::array<R3, 3> J = dodeca.inertiaTensor();
+    const double Rg = dodeca.radiusOfGyration();
+    CHECK(J[0].x() == Approx(J[1].y()).epsilon(1e-14));
+    CHECK(J[0].x() == Approx(J[2].z()).epsilon(1e-14));
+    CHECK(J[0].x() + J[1].y() + J[2].z()
+          == Approx(2 * dodeca.volume() * Rg * Rg).epsilon(1e-14));
+
+    // off-center polyhedron: the series includes odd orders, and matches the shifted pave
+    std::vector<R3> vertices = ff::cuboid::Pave::vertices3(1., 2., 3.);
+    const R3 t(0.3, 0.1, -0.2);
+    for (R3& v : vertices)
+        v += t;
+    ff::PolyhedralTopology topology = ff::cuboid::Pave::topology();
+    for (ff::PolygonalTopology& f : topology.faces)
+        f.symmetry_S2 = false; // not invariant under translation
+    const ff::Polyhedron moved(topology, vertices);
+    CHECK((moved.centroid() - t).mag() < 1e-14);
+    CHECK(moved.radiusOfGyration() == Approx(std::sqrt(14. / 12)).epsilon(1e-13));
+    const ff::cuboid::Pave centered(1., 2., 3.);
+    for (double s : {1e-6, 1e-4, 2e-3}) {
+        const C3 q(0.3 * s, complex_t(-0.5 * s, 0.1 * s), 0.8 * s);
+        CHECK(std::abs(moved.formfactor(q) - ff_aux::exp_I(t.dot(q)) * centered.formfactor(q))
+              <= 1e-15 * moved.volume());
+    }
+}
+
+TEST_CASE("Polyhedron:Accuracy", "")
+{
+    const ff::Accuracy standard;
+    const ff::Accuracy eps = ff::Accuracy::forTolerance(standard.tolerance);
+    CHECK(eps.q_limit_series == Approx(standard.q_limit_series).epsilon(1e-14));
+    CHECK(eps.qpa_limit_series == standard.qpa_limit_series);
+    CHECK(eps.seriesOrder() == 6);
+
+    const std::vector<C3> q = testWavevectors();
+    ff::platonic::Dodecahedron dodeca(0.9);
+    ff::cuboid::Pave pave(1., 2., 3.);
+    ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    for (double tolerance : {1e-10, 1e-6}) {
+        const ff::Accuracy acc = ff::Accuracy::forTolerance(tolerance);
+        CHECK(acc.q_limit_series > standard.q_limit_series);
+        for (ff::Polyhedron* p : std::vector<ff::Polyhedron*>{&dodeca, &pave}) {
+            const std::vector<complex_t> F0 = p->formfactor(q);
+            p->setAccuracy(acc);
+            const std::vector<complex_t> F = p->formfactor(q);
+            p->setAccuracy(standard);
+            for (size_t i = 0; i < q.size(); ++i)
+                CHECK(std::abs(F[i] - F0[i]) <= tolerance * std::abs(F0[i]) + 1e-11 * p->volume());
+        }
+        const std::vector<complex_t> G0 = prism.formfactor(q);
+        prism.setAccuracy(acc);
+        const std::vector<complex_t> G = prism.formfactor(q);
+        prism.setAccuracy(standard);
+        for (size_t i = 0; i < q.size(); ++i)
+            CHECK(std::abs(G[i] - G0[i]) <= tolerance * std::abs(G0[i]) + 1e-11 * prism.area());
+    }
+
+    ff::Accuracy invalid;
+    invalid.tolerance = 0;
+    CHECK_THROWS(dodeca.setAccuracy(invalid));
+    invalid = ff::Accuracy();
+    invalid.q_limit_series = 10;
+    CHECK_THROWS(prism.setAccuracy(invalid));
+}
+
+TEST_CASE("Polyhedron:MixedPrecision", "")
+{
+    // no single-precision window for tight tolerances
+    const ff::Accuracy tight = ff::Accuracy::forTolerance(1e-8, ff::Precision::Mixed);
+    CHECK(tight.q_min_single > tight.q_max_single);
+
+    const double tolerance = 1e-3;
+    const ff::Accuracy acc = ff::Accuracy::forTolerance(tolerance, ff::Precision::Mixed);
+    CHECK(acc.q_min_single < acc.q_max_single);
+
+    std::vector<C3> q = testWavevectors();
+    for (int i = 0; i < 500; ++i) {
+        const double t = i / 499.;
+        const R3 u = R3(std::cos(7 * t), std::sin(7 * t), 2 * t - 1).unit() * (20 * t);
+        q.push_back(C3(u.x(), u.y(), u.z()));
+    }
+    ff::platonic::Dodecahedron dodeca(0.9);
+    ff::cuboid::Pave pave(1., 2., 3.);
+    for (ff::Polyhedron* p : std::vector<ff::Polyhedron*>{&dodeca, &pave}) {
+        const std::vector<complex_t> F0 = p->formfactor(q);
+        p->setAccuracy(acc);
+        const std::vector<complex_t> F = p->formfactor(q);
+        p->setAccuracy(ff::Accuracy());
+        for (size_t i = 0; i < q.size(); ++i)
+            CHECK(std::abs(F[i] - F0[i]) <= tolerance * std::abs(F0[i]) + 1e-11 * p->volume());
+    }
+}
+
+TEST_CASE("Polyhedron:SetParameters", "")
+{
+    const std::vector<C3> q = testWavevectors();
+    const auto check = [&q](const ff::Polyhedron& p, const ff::Polyhedron& p0) {
+        CHECK(std::abs(p.volume() - p0.volume()) <= 1e-15 * p0.volume());
+        CHECK(p.radius() == p0.radius());
+        for (const C3& qi : q)
+            CHECK(std::abs(p.formfactor(qi) - p0.formfactor(qi)) <= 1e-13 * p0.volume());
+    };
+
+    ff::cuboid::Pave pave(1., 2., 3.); // faces with symmetry S2
+    pave.setParameters(2., 1.5, .7);
+    check(pave, ff::cuboid::Pave(2., 1.5, .7));
+
+    ff::platonic::Dodecahedron dodeca(1.); // symmetry Ci
+    dodeca.setParameters(.4);
+    check(dodeca, ff::platonic::Dodecahedron(.4));
+
+    ff::tri::TriangularBifrustum tribi(1., 1., .5);
+    tribi.setParameters(2., 1.2, .8);
+    check(tribi, ff::tri::TriangularBifrustum(2., 1.2, .8));
+
+    ff::penta::PentagonalBifrustum pentabi(1., 1., .5);
+    pentabi.setParameters(.5, 2., .3);
+    check(pentabi, ff::penta::PentagonalBifrustum(.5, 2., .3));
+
+    CHECK_THROWS(pave.setVertices(std::vector<R3>(5)));
+}
+
+TEST_CASE("Polyhedron:Topology", "")
+{
+    // a topology passed by the caller is copied, and may go out of scope
+    const std::vector<R3> V = ff::platonic::Tetrahedron::vertices(1.);
+    ff::PolyhedralTopology topology = ff::platonic::Tetrahedron::topology();
+    ff::Polyhedron p(topology, V);
+    topology.faces.clear();
+    p.setVertices(ff::platonic::Tetrahedron::vertices(1.5));
+    const ff::platonic::Tetrahedron p0(1.5);
+    for (const C3& qi : testWavevectors())
+        CHECK(std::abs(p.formfactor(qi) - p0.formfactor(qi)) <= 1e-13 * p0.volume());
+}
+
+TEST_CASE("Polyhedron:Intensity", "")
+{
+    const std::vector<C3> q = testWavevectors();
+    const ff::platonic::Dodecahedron dodeca(0.9);
+    const ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    ff::IntensityParameters par;
+    par.contrast = 2.5;
+    par.scale = 1e-4;
+    par.background = .01;
+    std::vector<double> I(q.size());
+    std::vector<float> If(q.size());
+
+    ff::intensity(dodeca, q.data(), I.data(), q.size(), par);
+    ff::intensity(dodeca, q.data(), If.data(), q.size(), par);
+    std::vector<complex_t> F = dodeca.formfactor(q);
+    for (size_t i = 0; i < q.size(); ++i) {
+        const double I0 = 6.25e-4 * std::norm(F[i]) + .01;
+        CHECK(std::abs(I[i] - I0) <= 1e-15 * I0);
+        CHECK(If[i] == static_cast<float>(I[i]));
+    }
+
+    ff::intensity(prism, q.data(), I.data(), q.size());
+    F = prism.formfactor(q);
+    for (size_t i = 0; i < q.size(); ++i)
+        CHECK(I[i] == std::norm(F[i]));
+}
+
+TEST_CASE("Polyhedron:Status", "")
+{
+    // construction
+    const ff::Expected<ff::platonic::Dodecahedron> made = ff::make<ff::platonic::Dodecahedron>(.9);
+    REQUIRE(made);
+    CHECK(made.value->outcome().ok());
+    const ff::Expected<ff::platonic::Tetrahedron> degenerate =
+        ff::make<ff::platonic::Tetrahedron>(0.);
+    CHECK(!degenerate);
+    CHECK(!degenerate.value);
+    CHECK(degenerate.outcome.status == ff::Status::InvalidGeometry);
+    CHECK_THROWS_AS(ff::platonic::Tetrahedron(0.), std::runtime_error);
+    const ff::Expected<ff::Prism> flat =
+        ff::make<ff::Prism>(false, 1., std::vector<R3>{{0., 0., 0.}, {1., 0., 0.}, {2., 0., 0.}});
+    CHECK(flat.outcome.status == ff::Status::InvalidGeometry);
+    const ff::platonic::Tetrahedron tetra0(std::nothrow, 0.);
+    CHECK_THROWS_AS(tetra0.formfactor(C3(1., 0., 0.)), std::runtime_error);
+    CHECK_THROWS_AS(tetra0.formfactor(R3(1., 0., 0.)), std::runtime_error);
+    const ff::Prism flat0(std::nothrow, false, 1., {{0., 0., 0.}, {1., 0., 0.}, {2., 0., 0.}});
+    CHECK_THROWS_AS(flat0.formfactor(C3(1., 0., 0.)), std::runtime_error);
+
+    // evaluation agrees with the throwing API
+    std::vector<C3> q = testWavevectors();
+    ff::platonic::Dodecahedron& dodeca = *made.value;
+    std::vector<complex_t> F(q.size());
+    std::vector<ff::Status> status(q.size());
+    dodeca.formfactor(q.data(), F.data(), status.data(), q.size());
+    const std::vector<complex_t> F0 = dodeca.formfactor(q);
+    for (size_t i = 0; i < q.size(); ++i) {
+        CHECK(status[i] == ff::Status::Ok);
+        CHECK(F[i] == F0[i]);
+    }
+    q.push_back(C3(std::nan(""), 0., 0.));
+    F.resize(q.size());
+    status.resize(q.size());
+    dodeca.formfactor(q.data(), F.data(), status.data(), q.size());
+    CHECK(status.back() == ff::Status::InvalidArgument);
+    CHECK(std::isnan(F.back().real()));
+
+    // changes of vertices
+    const ff::Outcome outcome = dodeca.trySetParameters(0.);
+    CHECK(outcome.status == ff::Status::InvalidArgument);
+    CHECK(dodeca.outcome().status == ff::Status::InvalidArgument);
+    dodeca.formfactor(q.data(), F.data(), status.data(), q.size());
+    CHECK(status[0] == ff::Status::InvalidArgument);
+    CHECK(std::isnan(F[0].real()));
+    CHECK_THROWS_AS(dodeca.formfactor(q[0]), std::invalid_argument);
+    CHECK_THROWS_AS(dodeca.formfactor(q[0].real()), std::invalid_argument);
+    CHECK_THROWS_AS(dodeca.formfactor(q), std::invalid_argument);
+    CHECK_THROWS_AS(dodeca.formfactor_ray(R3(0., 0., 1.), 1., 1., 4), std::invalid_argument);
+    CHECK_THROWS_AS(dodeca.formfactor_gradient(q[0], nullptr, nullptr), std::invalid_argument);
+    CHECK(dodeca.trySetParameters(.4).ok());
+    const ff::platonic::Dodecahedron dodeca4(.4);
+    for (size_t i = 0; i + 1 < q.size(); ++i)
+        CHECK(std::abs(dodeca.formfactor(q[i]) - dodeca4.formfactor(q[i]))
+              <= 1e-13 * dodeca4.volume());
+    CHECK(dodeca.trySetVertices(std::vector<R3>(5)).status == ff::Status::InvalidArgument);
+    CHECK(dodeca.trySetParameters(.4).ok());
+
+    // series in q_pa not converged: faces perpendicular to z are expanded
+    ff::Accuracy acc;
+    acc.n_limit_series = 1;
+    const std::vector<C3> qz{{1e-4, 0., 5.}, {complex_t(1e-4, 1e-6), 0., 5.}};
+    dodeca.setAccuracy(acc);
+    CHECK_THROWS_AS(dodeca.formfactor(qz), std::runtime_error);
+    dodeca.formfactor(qz.data(), F.data(), status.data(), qz.size());
+    CHECK(status[0] == ff::Status::NotConverged);
+    CHECK(status[1] == ff::Status::NotConverged);
+    ff::Prism prism(false, 2., {{0., 0., 0.}, {1., 0., 0.}, {.5, .8, 0.}});
+    prism.setAccuracy(acc);
+    CHECK_THROWS_AS(prism.formfactor(qz), std::runtime_error);
+    prism.formfactor(qz.data(), F.data(), status.data(), qz.size());
+    CHECK(status[0] == ff::Status::NotConverged);
+    CHECK(status[1] == ff::Status::NotConverged);
+}
+
+TEST_CASE("Polyhedron:Gradient", "")
+{
+    checkGradient<ff::cuboid::Pave>(&ff::cuboid::Pave::vertices3, 1., 2., 3.);
+    checkGradient<ff::penta::PentagonalBifrustum>(&ff::penta::PentagonalBifrustum::vertices3,
+                                                  1., 1.5, .5);
+    checkGradient<ff::tri::TriangularBifrustum>(&ff::tri::TriangularBifrustum::vertices3, 2.,
+                                                1.2, .8);
+    checkGradient<ff::platonic::Dodecahedron>(&ff::platonic::Dodecahedron::vertices, .9);
+
+    // the triangulation is built on first use, which may happen in several threads at once
+    const ff::platonic::Icosahedron icosa(1.);
+    const C3 q(1.3, -.4, .7);
+    std::vector<std::vector<C3>> dFdv(4, std::vector<C3>(icosa.nVertices()));
+    std::vector<std::thread> threads;
+    for (std::vector<C3>& d : dFdv)
+        threads.emplace_back([&icosa, &q, &d] { icosa.formfactor_gradient(q, nullptr, d.data()); });
+    for (std::thread& t : threads)
+        t.join();
+    for (const std::vector<C3>& d : dFdv)
+        CHECK(d == dFdv[0]);
+}
@@ -47,3 +47,26 @@ TEST_CASE("FF:Triangle", "")
     }
     CHECK(0 == failures);
 }
+
+//! Checks PolyhedralEdge::contrib against a direct sum, also beyond the coefficient table.
+
+TEST_CASE("FF:EdgeContrib", "")
+{
+    const ff::PolyhedralEdge E({-.3, -.4, 0.}, {.5, .2, 0.});
+    const C3 qpa{complex_t{.7, .1}, complex_t{-.4, .2}, 0.};
+    const complex_t qrperp{.3, -.2};
+    const complex_t u = E.qE(qpa);
+    const complex_t v1 = qrperp;
+    const complex_t v = E.qR(qpa) + v1;
+
+    for (int M : {1, 2, 20, 21, 22, 30, 41}) {
+        // sum_l=0^M/2 u^2l v^(M-2l) / (2l+1)!(M-2l)! - v1^M/M!
+        complex_t expected = -std::pow(v1, M) / std::tgamma(M + 1.);
+        for (int l = 0; l <= M / 2; ++l)
+            expected += std::pow(u, 2 * l) * std::pow(v, M - 2 * l)
+                        / (std::tgamma(2 * l + 2.) * std::tgamma(M - 2 * l + 1.));
+        complex_t result;
+        REQUIRE_NOTHROW(result = E.contrib(M, qpa, qrperp));
+        CHECK(std::abs(result - expected) <= 1e-13 * std::abs(expected));
+    }
+}